@@ -0,0 +1,806 @@
+#include "OrderBook.h"
+#include "MatchingEngine.h"
+#include "OrderPipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace LOB;
+
+// Microbenchmark suite: per-operation latency percentiles and throughput,
+// emitted as JSON so runs can be diffed between builds.
+//
+// Usage: bench [--depths 10,100,1000] [--orders 100000] [--seed 42] [--ladder LEVELS]
+//              [--shards 1,2,4] [--symbols 64] [--stops 0,1000000]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    std::vector<int> depths = {10, 100, 1000};
+    size_t orders = 100000;
+    uint64_t seed = 42;
+    size_t ladderLevels = 0;
+    std::vector<int> shardCounts = {1, 2, 4};
+    size_t symbols = 64;
+    std::vector<int> stopCounts = {0, 1000000};
+};
+
+constexpr Price MID = 100000;
+constexpr Price TICK = 1;
+
+// Defeats dead-code elimination of query results
+volatile uint64_t g_sink = 0;
+
+struct Result {
+    std::string name;
+    int depth;
+    size_t ops;
+    double seconds;
+    std::vector<uint64_t> latencies;  // ns per operation
+    int shards = 0;                   // Engine benchmarks only
+};
+
+class Recorder {
+public:
+    explicit Recorder(size_t expected) { latencies_.reserve(expected); }
+
+    template<typename Fn>
+    void time(Fn fn) {
+        auto start = Clock::now();
+        fn();
+        auto end = Clock::now();
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        latencies_.push_back(ns);
+        total_ += ns;
+    }
+
+    Result finish(const std::string& name, int depth) {
+        Result result{name, depth, latencies_.size(), static_cast<double>(total_) / 1e9, std::move(latencies_)};
+        return result;
+    }
+
+private:
+    std::vector<uint64_t> latencies_;
+    uint64_t total_ = 0;
+};
+
+OrderBookConfig makeConfig(const BenchOptions& options) {
+    OrderBookConfig config;
+    config.orderPoolCapacity = options.orders * 2 + 100000;
+    config.tradeSink = TradeSinkMode::NONE;
+    config.ladderLevels = options.ladderLevels;
+    config.ladderTickSize = TICK;
+    if (options.ladderLevels > 0) {
+        config.ladderBasePrice = MID - static_cast<Price>(options.ladderLevels / 2) * TICK;
+    }
+    return config;
+}
+
+// Fill `depth` levels per side around MID with `perLevel` orders each
+void seedBook(OrderBook& book, int depth, int perLevel, OrderId& nextId) {
+    for (int level = 1; level <= depth; ++level) {
+        for (int k = 0; k < perLevel; ++k) {
+            book.addOrder(Order(nextId++, Side::BUY, OrderType::LIMIT, MID - level * TICK, 100, 0));
+            book.addOrder(Order(nextId++, Side::SELL, OrderType::LIMIT, MID + level * TICK, 100, 0));
+        }
+    }
+}
+
+Result benchAddPassive(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+        Order order(nextId++, side, OrderType::LIMIT, price, 1 + rng() % 100, 0);
+        recorder.time([&] { book.addOrder(order); });
+    }
+    return recorder.finish("add_passive", depth);
+}
+
+Result benchAddAggressive(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 4, nextId);
+    std::mt19937_64 rng(options.seed);
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Quantity qty = 1 + rng() % 150;
+        Price limit = side == Side::BUY ? MID + depth * TICK : MID - depth * TICK;
+        Order order(nextId++, side, OrderType::LIMIT, limit, qty, 0);
+        recorder.time([&] { book.addOrder(order); });
+        // Replenish the touch (untimed) so the book shape stays stable
+        Side restingSide = side == Side::BUY ? Side::SELL : Side::BUY;
+        Price restingPrice = restingSide == Side::BUY ? MID - TICK : MID + TICK;
+        book.cancelOrder(order.id);  // Any unfilled remainder
+        book.addOrder(Order(nextId++, restingSide, OrderType::LIMIT, restingPrice, qty, 0));
+    }
+    return recorder.finish("add_aggressive", depth);
+}
+
+// Aggressive limit orders (as add_aggressive, depth 10) with `stops` pending stop orders
+// spread over 1000 trigger prices beyond the traded range, so none fire
+Result benchTradeWithStops(const BenchOptions& options, int stops) {
+    constexpr int DEPTH = 10;
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, DEPTH, 4, nextId);
+    for (int i = 0; i < stops; ++i) {
+        Price away = (100 + i % 1000) * TICK;
+        if (i % 2) {
+            book.addOrder(Order(nextId++, Side::BUY, OrderType::STOP, 0, 100, 0, MID + away));
+        } else {
+            book.addOrder(Order(nextId++, Side::SELL, OrderType::STOP, 0, 100, 0, MID - away));
+        }
+    }
+    std::mt19937_64 rng(options.seed);
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Quantity qty = 1 + rng() % 150;
+        Price limit = side == Side::BUY ? MID + DEPTH * TICK : MID - DEPTH * TICK;
+        Order order(nextId++, side, OrderType::LIMIT, limit, qty, 0);
+        recorder.time([&] { book.addOrder(order); });
+        Side restingSide = side == Side::BUY ? Side::SELL : Side::BUY;
+        Price restingPrice = restingSide == Side::BUY ? MID - TICK : MID + TICK;
+        book.cancelOrder(order.id);
+        book.addOrder(Order(nextId++, restingSide, OrderType::LIMIT, restingPrice, qty, 0));
+    }
+    return recorder.finish("trade_with_stops_" + std::to_string(stops), DEPTH);
+}
+
+// Pulling one participant's `orders` resting orders, interleaved level by level with another
+// participant's equal book over `depth` levels per side: one massCancel() call per round,
+// versus cancelOrder() on each of the same ids. Latencies are per round.
+Result benchMassCancel(const BenchOptions& options, int depth, bool byId) {
+    constexpr int ROUNDS = 10;
+    std::mt19937_64 rng(options.seed);
+    Recorder recorder(ROUNDS);
+    for (int round = 0; round < ROUNDS; ++round) {
+        OrderBookConfig config = makeConfig(options);
+        config.orderPoolCapacity = options.orders * 2 + 1000;
+        OrderBook book(config);
+        std::vector<OrderId> ids;
+        ids.reserve(options.orders);
+        OrderId nextId = 1;
+        for (size_t i = 0; i < 2 * options.orders; ++i) {
+            Side side = rng() % 2 ? Side::BUY : Side::SELL;
+            Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+            Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+            OwnerId owner = static_cast<OwnerId>(1 + i % 2);
+            if (owner == 1) {
+                ids.push_back(nextId);
+            }
+            book.addOrder(Order(nextId++, side, OrderType::LIMIT, price, 100, 0, 0, owner));
+        }
+        if (byId) {
+            recorder.time([&] {
+                for (OrderId id : ids) {
+                    g_sink = g_sink + book.cancelOrder(id);
+                }
+            });
+        } else {
+            recorder.time([&] { g_sink = g_sink + book.massCancel(1); });
+        }
+    }
+    return recorder.finish(byId ? "mass_cancel_by_id_loop" : "mass_cancel", depth);
+}
+
+// Market maker refreshing a 20-level ladder per side over a background book `depth` levels
+// deep: each refresh the mid moves -1/0/+1 tick and a couple of sizes change. One
+// replaceQuotes() per refresh, versus cancelling every quote and re-adding the ladder.
+// Latencies are per refresh.
+Result benchQuoteRefresh(const BenchOptions& options, int depth, bool cancelReplace) {
+    constexpr int LEVELS = 20;
+    constexpr OwnerId MAKER = 1;
+    size_t refreshes = std::max<size_t>(1, options.orders / LEVELS);
+    OrderBookConfig config = makeConfig(options);
+    config.orderPoolCapacity = options.orders + 1000;
+    OrderBook book(config);
+    std::mt19937_64 rng(options.seed);
+    OrderId nextId = 1;
+    for (int level = LEVELS + 2; level <= LEVELS + 2 + depth; ++level) {
+        book.addOrder(Order(nextId++, Side::BUY, OrderType::LIMIT, MID - level * TICK, 100, 0));
+        book.addOrder(Order(nextId++, Side::SELL, OrderType::LIMIT, MID + level * TICK, 100, 0));
+    }
+    std::vector<QuoteLevel> bids(LEVELS), asks(LEVELS);
+    std::vector<OrderId> live;
+    Quantity sizes[2][LEVELS];
+    for (auto& side : sizes) {
+        std::fill(std::begin(side), std::end(side), 100);
+    }
+    Price mid = MID;
+    Recorder recorder(refreshes);
+    for (size_t i = 0; i < refreshes; ++i) {
+        mid += (static_cast<Price>(rng() % 3) - 1) * TICK;
+        mid = std::min(std::max(mid, MID - TICK), MID + TICK);  // Stay inside the background book
+        for (int k = 0; k < 2; ++k) {
+            sizes[rng() % 2][rng() % LEVELS] = 50 + 50 * static_cast<Quantity>(rng() % 4);
+        }
+        for (int level = 0; level < LEVELS; ++level) {
+            bids[level] = QuoteLevel{mid - (level + 1) * TICK, sizes[0][level], nextId++};
+            asks[level] = QuoteLevel{mid + (level + 1) * TICK, sizes[1][level], nextId++};
+        }
+        if (cancelReplace) {
+            recorder.time([&] {
+                for (OrderId id : live) {
+                    book.cancelOrder(id);
+                }
+                live.clear();
+                for (int level = 0; level < LEVELS; ++level) {
+                    book.addOrder(Order(bids[level].id, Side::BUY, OrderType::LIMIT, bids[level].price,
+                                        bids[level].quantity, 0, 0, MAKER));
+                    book.addOrder(Order(asks[level].id, Side::SELL, OrderType::LIMIT, asks[level].price,
+                                        asks[level].quantity, 0, 0, MAKER));
+                    live.push_back(bids[level].id);
+                    live.push_back(asks[level].id);
+                }
+            });
+        } else {
+            recorder.time([&] { g_sink = g_sink + book.replaceQuotes(MAKER, bids, asks).amended; });
+        }
+    }
+    return recorder.finish(cancelReplace ? "quote_cancel_replace" : "quote_replace", depth);
+}
+
+// Opening auction of 10 x --orders limit orders spread over `depth` ticks either side of
+// MID (so the collected book crosses heavily): one uncross() per round, versus the same
+// orders through continuous matching. Latencies are per round.
+Result benchAuction(const BenchOptions& options, int depth, bool continuous) {
+    constexpr int ROUNDS = 3;
+    size_t count = options.orders * 10;
+    std::mt19937_64 rng(options.seed);
+    std::vector<Order> flow;
+    flow.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Price price = MID + (static_cast<Price>(rng() % static_cast<uint64_t>(2 * depth + 1)) - depth) * TICK;
+        flow.emplace_back(i + 1, side, OrderType::LIMIT, price, 1 + rng() % 200, 0);
+    }
+    Recorder recorder(ROUNDS);
+    for (int round = 0; round < ROUNDS; ++round) {
+        OrderBookConfig config = makeConfig(options);
+        config.orderPoolCapacity = count + 1000;
+        OrderBook book(config);
+        if (continuous) {
+            recorder.time([&] {
+                for (const Order& order : flow) {
+                    book.addOrder(order);
+                }
+            });
+        } else {
+            book.startAuction();
+            for (const Order& order : flow) {
+                book.addOrder(order);
+            }
+            recorder.time([&] { g_sink = g_sink + book.uncross().trades; });
+        }
+    }
+    return recorder.finish(continuous ? "auction_continuous" : "auction_uncross", depth);
+}
+
+Result benchCancel(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    std::vector<OrderId> ids;
+    ids.reserve(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+        ids.push_back(nextId);
+        book.addOrder(Order(nextId++, side, OrderType::LIMIT, price, 100, 0));
+    }
+    std::shuffle(ids.begin(), ids.end(), rng);
+    Recorder recorder(options.orders);
+    for (OrderId id : ids) {
+        recorder.time([&] { g_sink = g_sink + book.cancelOrder(id); });
+    }
+    return recorder.finish("cancel", depth);
+}
+
+Result benchModify(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    std::vector<std::pair<OrderId, Side>> resting;
+    size_t restingCount = std::min<size_t>(options.orders, 10000);
+    for (size_t i = 0; i < restingCount; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+        resting.emplace_back(nextId, side);
+        book.addOrder(Order(nextId++, side, OrderType::LIMIT, price, 100, 0));
+    }
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        const auto& [id, side] = resting[rng() % resting.size()];
+        Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+        Quantity qty = 1 + rng() % 100;
+        recorder.time([&] { g_sink = g_sink + book.modifyOrder(id, price, qty); });
+    }
+    return recorder.finish("modify", depth);
+}
+
+// Same-price size changes only (the common market-maker amend)
+Result benchAmendSize(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    std::vector<std::pair<OrderId, Price>> resting;
+    size_t restingCount = std::min<size_t>(options.orders, 10000);
+    for (size_t i = 0; i < restingCount; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+        resting.emplace_back(nextId, price);
+        book.addOrder(Order(nextId++, side, OrderType::LIMIT, price, 100, 0));
+    }
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        const auto& [id, price] = resting[rng() % resting.size()];
+        Quantity qty = 1 + rng() % 100;
+        recorder.time([&] { g_sink = g_sink + book.modifyOrder(id, price, qty); });
+    }
+    return recorder.finish("amend_size", depth);
+}
+
+Result benchMarketSweep(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    std::mt19937_64 rng(options.seed);
+    size_t sweeps = std::max<size_t>(1, options.orders / static_cast<size_t>(depth));
+    Recorder recorder(sweeps);
+    for (size_t i = 0; i < sweeps; ++i) {
+        // Rebuild one side (untimed), then sweep every level of it
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        for (int level = 1; level <= depth; ++level) {
+            Price price = side == Side::BUY ? MID + level * TICK : MID - level * TICK;
+            book.addOrder(Order(nextId++, side == Side::BUY ? Side::SELL : Side::BUY,
+                                OrderType::LIMIT, price, 100, 0));
+        }
+        Order sweep(nextId++, side, OrderType::MARKET, 0, static_cast<Quantity>(depth) * 100, 0);
+        recorder.time([&] { book.addOrder(sweep); });
+    }
+    return recorder.finish("market_sweep", depth);
+}
+
+Result benchBestBid(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        recorder.time([&] { g_sink = g_sink + static_cast<uint64_t>(book.getBestBid().value_or(0)); });
+    }
+    return recorder.finish("get_best_bid", depth);
+}
+
+// Pre-trade check: quantity available up to a random limit (prefix sums in ladder mode)
+Result benchCumulativeVolume(const BenchOptions& options, int depth) {
+    OrderBookConfig config = makeConfig(options);
+    config.prefixVolumes = true;
+    OrderBook book(config);
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Price limit = MID + 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        recorder.time([&] { g_sink = g_sink + book.getCumulativeVolume(Side::SELL, limit); });
+    }
+    return recorder.finish("cumulative_volume", depth);
+}
+
+// Top-10 read from the incremental depth cache; the book keeps churning between reads
+Result benchGetDepth(const BenchOptions& options, int depth) {
+    OrderBookConfig config = makeConfig(options);
+    config.depthLevels = 10;
+    OrderBook book(config);
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    DepthLevel top[10];
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        book.addOrder(Order(nextId++, Side::BUY, OrderType::LIMIT, MID - offset * TICK, 100, 0));
+        recorder.time([&] { g_sink = g_sink + book.getDepth(Side::BUY, top, 10); });
+        book.cancelOrder(nextId - 1);
+    }
+    return recorder.finish("get_depth_10", depth);
+}
+
+Result benchVolumeAtPrice(const BenchOptions& options, int depth) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::mt19937_64 rng(options.seed);
+    Recorder recorder(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Price price = MID - 1 - static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+        recorder.time([&] { g_sink = g_sink + book.getVolumeAtPrice(Side::BUY, price).value_or(0); });
+    }
+    return recorder.finish("get_volume_at_price", depth);
+}
+
+// Aggregate engine throughput: one producer feeding `shards` matching threads
+Result benchEngine(const BenchOptions& options, int shards) {
+    MatchingEngineConfig config;
+    config.shardCount = static_cast<size_t>(shards);
+    config.bookConfig = makeConfig(options);
+    config.bookConfig.orderPoolCapacity = 1 << 14;
+    MatchingEngine engine(config);
+    for (SymbolId s = 0; s < options.symbols; ++s) {
+        engine.addSymbol(s);
+    }
+    
+    // Pre-generate a passive add / cancel / occasional aggressive stream per event
+    size_t totalEvents = options.orders * static_cast<size_t>(shards);
+    std::mt19937_64 rng(options.seed);
+    std::vector<EngineEvent> events(totalEvents);
+    std::vector<OrderId> nextId(options.symbols, 1);
+    for (EngineEvent& event : events) {
+        event.symbol = static_cast<SymbolId>(rng() % options.symbols);
+        OrderId& id = nextId[event.symbol];
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        int action = static_cast<int>(rng() % 10);
+        if (action < 4 && id > 1) {
+            event.type = EngineEventType::CANCEL;
+            event.order.id = 1 + rng() % (id - 1);
+        } else {
+            bool aggressive = action == 9;
+            Price offset = 1 + static_cast<Price>(rng() % 50);
+            Price price = (side == Side::BUY) != aggressive ? MID - offset : MID + offset;
+            event.type = EngineEventType::ADD;
+            event.order = Order(id++, side, OrderType::LIMIT, price, 1 + rng() % 100, 0);
+        }
+    }
+    
+    auto start = Clock::now();
+    engine.start();
+    for (const EngineEvent& event : events) {
+        while (!engine.submit(event)) {
+        }
+    }
+    engine.stop();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    Result result{"engine_throughput", 0, totalEvents, seconds, {}};
+    result.shards = shards;
+    return result;
+}
+
+// Mixed passive/aggressive limit flow shared by the direct and pipelined runs
+std::vector<Order> makePipelineFlow(const BenchOptions& options) {
+    std::mt19937_64 rng(options.seed);
+    std::vector<Order> flow;
+    flow.reserve(options.orders);
+    for (size_t i = 0; i < options.orders; ++i) {
+        Side side = rng() % 2 ? Side::BUY : Side::SELL;
+        bool aggressive = rng() % 10 == 0;
+        Price offset = 1 + static_cast<Price>(rng() % 50);
+        Price price = (side == Side::BUY) != aggressive ? MID - offset : MID + offset;
+        flow.emplace_back(static_cast<OrderId>(i + 1), side, OrderType::LIMIT, price, 1 + rng() % 100, 0);
+    }
+    return flow;
+}
+
+// Passive adds interleaved with runs of cancels against resting orders
+std::vector<Order> makeBatchFlow(const BenchOptions& options, int depth, OrderId& nextId) {
+    std::mt19937_64 rng(options.seed);
+    std::vector<Order> flow;
+    std::vector<OrderId> live;
+    flow.reserve(options.orders);
+    while (flow.size() < options.orders) {
+        if (live.size() < 64 || rng() % 2) {
+            Side side = rng() % 2 ? Side::BUY : Side::SELL;
+            Price offset = 1 + static_cast<Price>(rng() % static_cast<uint64_t>(depth));
+            Price price = side == Side::BUY ? MID - offset * TICK : MID + offset * TICK;
+            live.push_back(nextId);
+            flow.emplace_back(nextId++, side, OrderType::LIMIT, price, 1 + rng() % 100, 0);
+            continue;
+        }
+        for (size_t k = 0, run = 1 + rng() % 16; k < run && flow.size() < options.orders; ++k) {
+            size_t pick = static_cast<size_t>(rng() % live.size());
+            flow.emplace_back(live[pick], Side::BUY, OrderType::CANCEL, 0, 0, 0);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+    return flow;
+}
+
+// Same flow submitted through processBatch; latency is per event, amortized over its batch
+Result benchBatch(const BenchOptions& options, int depth, size_t batchSize) {
+    OrderBook book(makeConfig(options));
+    OrderId nextId = 1;
+    seedBook(book, depth, 1, nextId);
+    std::vector<Order> flow = makeBatchFlow(options, depth, nextId);
+    Recorder recorder(flow.size() / batchSize + 1);
+    for (size_t start = 0; start < flow.size(); start += batchSize) {
+        size_t count = std::min(batchSize, flow.size() - start);
+        recorder.time([&] { g_sink = g_sink + book.processBatch(flow.data() + start, count).fills; });
+    }
+    Result result = recorder.finish("batch_" + std::to_string(batchSize), depth);
+    for (uint64_t& ns : result.latencies) {
+        ns /= batchSize;
+    }
+    result.ops = flow.size();
+    return result;
+}
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+// Baseline: the caller's thread runs addOrder synchronously
+Result benchPipelineDirect(const BenchOptions& options) {
+    std::vector<Order> flow = makePipelineFlow(options);
+    OrderBook book(makeConfig(options));
+    Recorder recorder(flow.size());
+    auto start = Clock::now();
+    for (const Order& order : flow) {
+        recorder.time([&] { book.addOrder(order); });
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    Result result = recorder.finish("pipeline_direct", 0);
+    result.seconds = seconds;
+    return result;
+}
+
+// Producer -> SPSC ring -> matching thread -> result ring -> consumer; latency is submit-to-ack
+Result benchPipeline(const BenchOptions& options, WaitStrategy strategy, const char* name) {
+    std::vector<Order> flow = makePipelineFlow(options);
+    PipelineConfig config;
+    config.waitStrategy = strategy;
+    config.bookConfig = makeConfig(options);
+    OrderPipeline pipeline(config);
+    
+    std::vector<uint64_t> latencies;
+    latencies.reserve(flow.size());
+    std::thread consumer([&] {
+        while (latencies.size() < flow.size()) {
+            size_t n = pipeline.drainResults([&](const PipelineResult& result) {
+                if (result.type == PipelineResultType::ACK) {
+                    latencies.push_back(nowNanos() - result.tag);
+                }
+            });
+            if (n == 0 && strategy != WaitStrategy::SPIN) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    auto start = Clock::now();
+    pipeline.start();
+    for (const Order& order : flow) {
+        PipelineEvent event;
+        event.order = order;
+        event.tag = nowNanos();
+        while (!pipeline.submit(0, event)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    pipeline.stop();
+    return Result{name, 0, flow.size(), seconds, std::move(latencies)};
+}
+
+// Writer-side addOrder latency with the seqlock top of book published after every event,
+// while `readers` threads poll getTopOfBook() in a tight loop
+Result benchTopOfBook(const BenchOptions& options, size_t readers) {
+    std::vector<Order> flow = makePipelineFlow(options);
+    OrderBookConfig config = makeConfig(options);
+    config.publishTopOfBook = true;
+    OrderBook book(config);
+    
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            uint64_t seen = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                seen += book.getTopOfBook().sequence;
+            }
+            g_sink = g_sink + seen;
+        });
+    }
+    Recorder recorder(flow.size());
+    for (const Order& order : flow) {
+        recorder.time([&] { book.addOrder(order); });
+    }
+    stop.store(true);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return recorder.finish("top_of_book_readers_" + std::to_string(readers), 0);
+}
+
+// Writer-side addOrder latency with every book event published to a shared-memory feed
+// while `readers` threads poll it through their own mappings; should not move with readers
+Result benchFeed(const BenchOptions& options, size_t readers) {
+    std::vector<Order> flow = makePipelineFlow(options);
+    std::string name = "/lob_bench_feed";
+    MarketDataPublisher feed;
+    Recorder recorder(flow.size());
+    if (!feed.create(name, 1 << 16)) {
+        return recorder.finish("feed_readers_" + std::to_string(readers), 0);  // No shared memory here
+    }
+    OrderBook book(makeConfig(options));
+    book.setMarketDataFeed(&feed);
+    
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            MarketDataReader reader;
+            if (!reader.attach(name)) {
+                return;
+            }
+            FeedEvent event;
+            uint64_t seen = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (reader.poll(event) == FeedStatus::EVENT) {
+                    seen += event.quantity;
+                }
+            }
+            g_sink = g_sink + seen;
+        });
+    }
+    for (const Order& order : flow) {
+        recorder.time([&] { book.addOrder(order); });
+    }
+    stop.store(true);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return recorder.finish("feed_readers_" + std::to_string(readers), 0);
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+void writeJson(std::ostream& out, const BenchOptions& options, std::vector<Result>& results) {
+    out << "{\n";
+    out << "  \"seed\": " << options.seed << ",\n";
+    out << "  \"orders\": " << options.orders << ",\n";
+    out << "  \"ladder_levels\": " << options.ladderLevels << ",\n";
+    out << "  \"stats_enabled\": " << (OrderBook().getStats().enabled ? "true" : "false") << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result& r = results[i];
+        std::sort(r.latencies.begin(), r.latencies.end());
+        double throughput = r.seconds > 0 ? static_cast<double>(r.ops) / r.seconds : 0.0;
+        out << "    {\"benchmark\": \"" << r.name << "\", \"depth\": " << r.depth;
+        if (r.shards > 0) {
+            out << ", \"shards\": " << r.shards;
+        }
+        out << ", \"ops\": " << r.ops
+            << ", \"throughput_ops_per_sec\": " << static_cast<uint64_t>(throughput)
+            << ", \"latency_ns\": {\"p50\": " << percentile(r.latencies, 0.50)
+            << ", \"p99\": " << percentile(r.latencies, 0.99)
+            << ", \"p99_9\": " << percentile(r.latencies, 0.999)
+            << ", \"max\": " << (r.latencies.empty() ? 0 : r.latencies.back()) << "}}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+std::vector<int> parseList(const std::string& text, int minimum = 1) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::max(minimum, std::atoi(item.c_str())));
+        }
+    }
+    return values;
+}
+
+bool parseArgs(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--depths") {
+            options.depths = parseList(value);
+        } else if (arg == "--orders") {
+            options.orders = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--ladder") {
+            options.ladderLevels = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--shards") {
+            options.shardCounts = parseList(value);
+        } else if (arg == "--stops") {
+            options.stopCounts = parseList(value, 0);
+        } else if (arg == "--symbols") {
+            options.symbols = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return !options.depths.empty() && options.orders > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "Usage: bench [--depths 10,100,1000] [--orders N] [--seed S] [--ladder LEVELS]"
+                     " [--shards 1,2,4] [--symbols N] [--stops 0,1000000]\n";
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (int depth : options.depths) {
+        results.push_back(benchAddPassive(options, depth));
+        results.push_back(benchAddAggressive(options, depth));
+        results.push_back(benchCancel(options, depth));
+        results.push_back(benchModify(options, depth));
+        results.push_back(benchAmendSize(options, depth));
+        results.push_back(benchMarketSweep(options, depth));
+        results.push_back(benchBestBid(options, depth));
+        results.push_back(benchVolumeAtPrice(options, depth));
+        results.push_back(benchGetDepth(options, depth));
+        results.push_back(benchCumulativeVolume(options, depth));
+        results.push_back(benchBatch(options, depth, 1));
+        results.push_back(benchBatch(options, depth, 64));
+        results.push_back(benchMassCancel(options, depth, false));
+        results.push_back(benchMassCancel(options, depth, true));
+        results.push_back(benchQuoteRefresh(options, depth, false));
+        results.push_back(benchQuoteRefresh(options, depth, true));
+    }
+    results.push_back(benchAuction(options, 100, false));
+    results.push_back(benchAuction(options, 100, true));
+    for (int stops : options.stopCounts) {
+        results.push_back(benchTradeWithStops(options, stops));
+    }
+    for (int shards : options.shardCounts) {
+        results.push_back(benchEngine(options, shards));
+    }
+    results.push_back(benchPipelineDirect(options));
+    results.push_back(benchPipeline(options, WaitStrategy::SPIN, "pipeline_spin"));
+    results.push_back(benchPipeline(options, WaitStrategy::YIELD, "pipeline_yield"));
+    results.push_back(benchPipeline(options, WaitStrategy::FUTEX, "pipeline_futex"));
+    results.push_back(benchTopOfBook(options, 0));
+    results.push_back(benchTopOfBook(options, 2));
+    results.push_back(benchFeed(options, 0));
+    results.push_back(benchFeed(options, 2));
+
+    writeJson(std::cout, options, results);
+    return 0;
+}
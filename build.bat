@@ -15,7 +15,7 @@ if not exist "build" mkdir build
 
 REM Compile
 echo Compiling...
-g++ -std=c++17 -O3 -Wall -Wextra -Iinclude src/OrderBook.cpp src/main.cpp -o build/orderbook.exe
+g++ -std=c++17 -O3 -Wall -Wextra -Iinclude src/OrderBook.cpp src/Journal.cpp src/TradeTape.cpp src/MarketDataFeed.cpp src/MappedFile.cpp src/Snapshot.cpp src/MatchingEngine.cpp src/OrderPipeline.cpp src/WaitStrategy.cpp src/FlowGenerator.cpp src/main.cpp -o build/orderbook.exe
 
 if %ERRORLEVEL% EQU 0 (
     echo Build successful! Executable: build\orderbook.exe
@@ -0,0 +1,444 @@
+#pragma once
+
+#include "Order.h"
+#include "OrderPool.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace LOB {
+
+// A price level contains a FIFO queue of pooled orders (intrusive list for O(1) erase)
+struct PriceLevel {
+    Price price;
+    OrderQueue orders;
+    Quantity totalQuantity;
+
+    PriceLevel(Price p) : price(p), totalQuantity(0) {}
+};
+
+inline unsigned countTrailingZeros(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned countLeadingZeros(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return 63u - static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_clzll(x));
+#endif
+}
+
+// Contiguous array of price levels indexed by (price - base) / tick.
+// A two-level occupancy bitmap (one summary bit per 64-level word) finds the
+// next occupied level with a couple of ctz/clz scans instead of a tree walk.
+class PriceLadder {
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    void init(Price base, Price tick, size_t levelCount) {
+        base_ = base;
+        tick_ = tick;
+        levels_.clear();
+        levels_.reserve(levelCount);
+        for (size_t i = 0; i < levelCount; ++i) {
+            levels_.emplace_back(base + static_cast<Price>(i) * tick);
+        }
+        words_.assign((levelCount + 63) / 64, 0);
+        summary_.assign((words_.size() + 63) / 64, 0);
+        tree_.clear();
+    }
+
+    // Optional Fenwick tree over level totals (cumulative volume in O(log N)).
+    // Updates wrap modulo 2^64, so removals are added as negated deltas.
+    void enablePrefixSums() { tree_.assign(levels_.size() + 1, 0); }
+    bool prefixSumsEnabled() const { return !tree_.empty(); }
+
+    void addToPrefix(size_t i, Quantity delta) {
+        for (size_t k = i + 1; k < tree_.size(); k += k & (~k + 1)) {
+            tree_[k] += delta;
+        }
+    }
+
+    size_t memoryBytes() const {
+        return levels_.capacity() * sizeof(PriceLevel) +
+               (words_.capacity() + summary_.capacity()) * sizeof(uint64_t) +
+               tree_.capacity() * sizeof(Quantity);
+    }
+
+    // Sum of the totals of levels [0, count)
+    Quantity prefixSum(size_t count) const {
+        Quantity sum = 0;
+        for (size_t k = count; k > 0; k &= k - 1) {
+            sum += tree_[k];
+        }
+        return sum;
+    }
+
+    bool enabled() const { return !levels_.empty(); }
+    size_t size() const { return levels_.size(); }
+    Price base() const { return base_; }
+    Price tick() const { return tick_; }
+
+    // True if the price falls on a tick inside the window
+    bool contains(Price price) const {
+        if (levels_.empty() || price < base_) {
+            return false;
+        }
+        Price offset = price - base_;
+        return offset % tick_ == 0 && static_cast<size_t>(offset / tick_) < levels_.size();
+    }
+
+    size_t indexOf(Price price) const { return static_cast<size_t>((price - base_) / tick_); }
+    bool owns(const PriceLevel* level) const {
+        return !levels_.empty() && level >= levels_.data() && level < levels_.data() + levels_.size();
+    }
+    size_t indexOf(const PriceLevel* level) const { return static_cast<size_t>(level - levels_.data()); }
+
+    PriceLevel& at(size_t i) { return levels_[i]; }
+    const PriceLevel& at(size_t i) const { return levels_[i]; }
+
+    bool occupied(size_t i) const { return (words_[i >> 6] >> (i & 63)) & 1; }
+
+    void markOccupied(size_t i) {
+        words_[i >> 6] |= uint64_t(1) << (i & 63);
+        summary_[i >> 12] |= uint64_t(1) << ((i >> 6) & 63);
+    }
+
+    void markEmpty(size_t i) {
+        size_t w = i >> 6;
+        words_[w] &= ~(uint64_t(1) << (i & 63));
+        if (words_[w] == 0) {
+            summary_[w >> 6] &= ~(uint64_t(1) << (w & 63));
+        }
+    }
+
+    // Lowest occupied index >= from, or NPOS
+    size_t findNext(size_t from) const {
+        if (from >= levels_.size()) {
+            return NPOS;
+        }
+        size_t w = from >> 6;
+        uint64_t bits = words_[w] & (~uint64_t(0) << (from & 63));
+        if (bits) {
+            return (w << 6) + countTrailingZeros(bits);
+        }
+        size_t nextWord = w + 1;
+        for (size_t s = nextWord >> 6; s < summary_.size(); ++s) {
+            uint64_t sbits = summary_[s];
+            if (s == (nextWord >> 6)) {
+                sbits &= (nextWord & 63) ? (~uint64_t(0) << (nextWord & 63)) : ~uint64_t(0);
+            }
+            if (sbits) {
+                size_t word = (s << 6) + countTrailingZeros(sbits);
+                return (word << 6) + countTrailingZeros(words_[word]);
+            }
+        }
+        return NPOS;
+    }
+
+    // Highest occupied index <= from, or NPOS
+    size_t findPrev(size_t from) const {
+        if (levels_.empty()) {
+            return NPOS;
+        }
+        if (from >= levels_.size()) {
+            from = levels_.size() - 1;
+        }
+        size_t w = from >> 6;
+        uint64_t bits = words_[w] & lowMask(from & 63);
+        if (bits) {
+            return (w << 6) + 63 - countLeadingZeros(bits);
+        }
+        if (w == 0) {
+            return NPOS;
+        }
+        size_t prevWord = w - 1;
+        for (size_t s = (prevWord >> 6) + 1; s-- > 0;) {
+            uint64_t sbits = summary_[s];
+            if (s == (prevWord >> 6)) {
+                sbits &= lowMask(prevWord & 63);
+            }
+            if (sbits) {
+                size_t word = (s << 6) + 63 - countLeadingZeros(sbits);
+                return (word << 6) + 63 - countLeadingZeros(words_[word]);
+            }
+        }
+        return NPOS;
+    }
+
+    size_t lowest() const { return findNext(0); }
+    size_t highest() const { return levels_.empty() ? NPOS : findPrev(levels_.size() - 1); }
+
+private:
+    // Bits [0, bit] set
+    static uint64_t lowMask(size_t bit) {
+        return bit == 63 ? ~uint64_t(0) : ((uint64_t(1) << (bit + 1)) - 1);
+    }
+
+    Price base_ = 0;
+    Price tick_ = 1;
+    std::vector<PriceLevel> levels_;
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> summary_;
+    std::vector<Quantity> tree_;
+};
+
+// One side of the book: an optional tick ladder around the mid, with prices
+// outside the window (or off-tick) falling back to an ordered map.
+// Compare orders levels by priority (std::greater for bids, std::less for asks).
+// Level addresses are stable for as long as the level exists.
+template<typename Compare>
+class BookSide {
+    static constexpr bool kDescending = std::is_same<Compare, std::greater<Price>>::value;
+
+public:
+    void initLadder(Price base, Price tick, size_t levelCount) {
+        ladder_.init(base, tick, levelCount);
+        if (prefixVolumes_) {
+            ladder_.enablePrefixSums();
+        }
+    }
+    // Keep a Fenwick tree over the ladder's level totals (takes effect with the ladder)
+    void enablePrefixVolumes() {
+        prefixVolumes_ = true;
+        if (ladder_.enabled()) {
+            ladder_.enablePrefixSums();
+        }
+    }
+    bool ladderEnabled() const { return ladder_.enabled(); }
+    const PriceLadder& ladder() const { return ladder_; }
+
+    bool empty() const { return levelCount_ == 0; }
+    size_t levelCount() const { return levelCount_; }
+
+    PriceLevel& findOrCreate(Price price) {
+        if (ladder_.contains(price)) {
+            size_t i = ladder_.indexOf(price);
+            if (!ladder_.occupied(i)) {
+                ladder_.markOccupied(i);
+                ++levelCount_;
+            }
+            return ladder_.at(i);
+        }
+        auto [it, inserted] = overflow_.try_emplace(price, price);
+        if (inserted) {
+            ++levelCount_;
+        }
+        return it->second;
+    }
+
+    // Bulk-load path: levels must arrive in priority order (best first)
+    PriceLevel& appendLevel(Price price) {
+        if (ladder_.contains(price)) {
+            return findOrCreate(price);
+        }
+        size_t before = overflow_.size();
+        auto it = overflow_.emplace_hint(overflow_.end(), price, price);
+        levelCount_ += overflow_.size() - before;
+        return it->second;
+    }
+
+    // Drop every level (the ladder window itself is kept)
+    void clear() {
+        for (size_t i = ladder_.lowest(); i != PriceLadder::NPOS; i = ladder_.findNext(i + 1)) {
+            PriceLevel& level = ladder_.at(i);
+            level.orders = OrderQueue();
+            level.totalQuantity = 0;
+            ladder_.markEmpty(i);
+        }
+        overflow_.clear();
+        levelCount_ = 0;
+        if (ladder_.prefixSumsEnabled()) {
+            ladder_.enablePrefixSums();
+        }
+    }
+
+    // Ladder arrays plus overflow map nodes (node header estimated as 4 words)
+    size_t memoryBytes() const {
+        constexpr size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+        return ladder_.memoryBytes() +
+               overflow_.size() * (sizeof(typename decltype(overflow_)::value_type) + MAP_NODE_OVERHEAD);
+    }
+
+    // Every change to a level's total goes through these so prefix sums stay in step
+    void addQuantity(PriceLevel& level, Quantity quantity) {
+        level.totalQuantity += quantity;
+        if (ladder_.prefixSumsEnabled() && ladder_.owns(&level)) {
+            ladder_.addToPrefix(ladder_.indexOf(&level), quantity);
+        }
+    }
+
+    void removeQuantity(PriceLevel& level, Quantity quantity) {
+        level.totalQuantity -= quantity;
+        if (ladder_.prefixSumsEnabled() && ladder_.owns(&level)) {
+            ladder_.addToPrefix(ladder_.indexOf(&level), Quantity(0) - quantity);
+        }
+    }
+
+    // Total quantity resting at `limit` or better. Ladder levels come from the prefix sums
+    // when enabled (overflow levels are walked); otherwise levels are walked best-first,
+    // stopping once `enough` has been reached.
+    Quantity volumeThrough(Price limit, Quantity enough = std::numeric_limits<Quantity>::max()) const {
+        Quantity total = 0;
+        if (ladder_.prefixSumsEnabled()) {
+            total = ladderVolumeThrough(limit);
+            for (const auto& [price, level] : overflow_) {
+                if (Compare()(limit, price)) {
+                    break;
+                }
+                total += level.totalQuantity;
+            }
+            return total;
+        }
+        forEachLevel([&](const PriceLevel& level) {
+            if (Compare()(limit, level.price)) {
+                return false;
+            }
+            total += level.totalQuantity;
+            return total < enough;
+        });
+        return total;
+    }
+
+    // Pull a ladder level into cache ahead of use (map levels are not worth chasing)
+    void prefetch(Price price) const {
+#if defined(__GNUC__) || defined(__clang__)
+        if (ladder_.contains(price)) {
+            __builtin_prefetch(&ladder_.at(ladder_.indexOf(price)));
+        }
+#else
+        (void)price;
+#endif
+    }
+
+    PriceLevel* find(Price price) {
+        return const_cast<PriceLevel*>(static_cast<const BookSide*>(this)->find(price));
+    }
+
+    const PriceLevel* find(Price price) const {
+        if (ladder_.contains(price)) {
+            size_t i = ladder_.indexOf(price);
+            return ladder_.occupied(i) ? &ladder_.at(i) : nullptr;
+        }
+        auto it = overflow_.find(price);
+        return it == overflow_.end() ? nullptr : &it->second;
+    }
+
+    // Drop a level that has become empty
+    void erase(PriceLevel& level) {
+        --levelCount_;
+        if (ladder_.owns(&level)) {
+            level.totalQuantity = 0;
+            ladder_.markEmpty(ladder_.indexOf(&level));
+        } else {
+            overflow_.erase(level.price);
+        }
+    }
+
+    PriceLevel* best() {
+        return const_cast<PriceLevel*>(static_cast<const BookSide*>(this)->best());
+    }
+
+    const PriceLevel* best() const {
+        const PriceLevel* fromLadder = nullptr;
+        if (ladder_.enabled()) {
+            size_t i = kDescending ? ladder_.highest() : ladder_.lowest();
+            if (i != PriceLadder::NPOS) {
+                fromLadder = &ladder_.at(i);
+            }
+        }
+        const PriceLevel* fromMap = overflow_.empty() ? nullptr : &overflow_.begin()->second;
+        return better(fromLadder, fromMap);
+    }
+
+    // Next level after `level` in priority order, or nullptr
+    const PriceLevel* next(const PriceLevel& level) const {
+        return better(ladderAfter(level.price), mapAfter(level.price));
+    }
+
+    template<typename Fn>
+    void forEachLevel(Fn fn) const {
+        for (const PriceLevel* level = best(); level != nullptr; level = next(*level)) {
+            if (!fn(*level)) {
+                break;
+            }
+        }
+    }
+
+private:
+    static const PriceLevel* better(const PriceLevel* a, const PriceLevel* b) {
+        if (!a) return b;
+        if (!b) return a;
+        return Compare()(a->price, b->price) ? a : b;
+    }
+
+    // Best occupied ladder level strictly worse than price
+    const PriceLevel* ladderAfter(Price price) const {
+        if (!ladder_.enabled()) {
+            return nullptr;
+        }
+        Price base = ladder_.base();
+        Price tick = ladder_.tick();
+        size_t i;
+        if (kDescending) {
+            if (price <= base) {
+                return nullptr;
+            }
+            i = ladder_.findPrev(static_cast<size_t>((price - base - 1) / tick));
+        } else {
+            size_t start = price < base ? 0 : static_cast<size_t>((price - base) / tick) + 1;
+            i = ladder_.findNext(start);
+        }
+        return i == PriceLadder::NPOS ? nullptr : &ladder_.at(i);
+    }
+
+    // Prefix-sum part of volumeThrough(): bids at >= limit, asks at <= limit
+    Quantity ladderVolumeThrough(Price limit) const {
+        size_t n = ladder_.size();
+        Price base = ladder_.base();
+        Price tick = ladder_.tick();
+        if (kDescending) {
+            size_t first = 0;
+            if (limit > base) {
+                Price offset = limit - base;
+                first = static_cast<size_t>(offset / tick + (offset % tick != 0));
+            }
+            return first >= n ? 0 : ladder_.prefixSum(n) - ladder_.prefixSum(first);
+        }
+        if (limit < base) {
+            return 0;
+        }
+        size_t count = std::min(n, static_cast<size_t>((limit - base) / tick) + 1);
+        return ladder_.prefixSum(count);
+    }
+
+    const PriceLevel* mapAfter(Price price) const {
+        auto it = overflow_.upper_bound(price);
+        return it == overflow_.end() ? nullptr : &it->second;
+    }
+
+    PriceLadder ladder_;
+    std::map<Price, PriceLevel, Compare> overflow_;
+    size_t levelCount_ = 0;
+    bool prefixVolumes_ = false;
+};
+
+} // namespace LOB
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BookSide.h"
+#include <cstring>
+#include <vector>
+
+namespace LOB {
+
+// One aggregated price level as published to depth consumers
+struct DepthLevel {
+    Price price;
+    Quantity quantity;
+};
+
+enum class DepthAction : uint8_t {
+    NEW,     // Level appeared
+    CHANGE,  // Level total changed
+    DELETE   // Level emptied (quantity is 0)
+};
+
+// Incremental L2 update: the new total of one level after an event
+struct DepthUpdate {
+    Price price;
+    Quantity quantity;
+    Side side;
+    DepthAction action;
+};
+
+using DepthCallback = void (*)(void* context, const DepthUpdate& update);
+
+// Top-N aggregated levels of one book side, best first, kept in a contiguous array so a
+// read is a memcpy. Updated per level change; when a level leaves a full window the next
+// one is pulled in from the book.
+template<typename Compare>
+class DepthSide {
+public:
+    void init(size_t maxLevels) {
+        levels_.assign(maxLevels, DepthLevel{0, 0});
+        count_ = 0;
+    }
+
+    size_t size() const { return count_; }
+    const DepthLevel* data() const { return levels_.data(); }
+    size_t memoryBytes() const { return levels_.capacity() * sizeof(DepthLevel); }
+
+    // `book` must already reflect the change; total 0 means the level is gone
+    void apply(const BookSide<Compare>& book, Price price, Quantity total) {
+        size_t capacity = levels_.size();
+        if (capacity == 0) {
+            return;
+        }
+        size_t i = 0;
+        while (i < count_ && Compare()(levels_[i].price, price)) {
+            ++i;
+        }
+        if (i < count_ && levels_[i].price == price) {
+            if (total > 0) {
+                levels_[i].quantity = total;
+                return;
+            }
+            bool wasFull = count_ == capacity;
+            std::memmove(&levels_[i], &levels_[i + 1], (count_ - i - 1) * sizeof(DepthLevel));
+            --count_;
+            if (wasFull) {
+                refillBack(book);
+            }
+            return;
+        }
+        // Not cached: only matters if it lands inside the window
+        if (total == 0 || i == capacity) {
+            return;
+        }
+        if (count_ == capacity) {
+            --count_;
+        }
+        std::memmove(&levels_[i + 1], &levels_[i], (count_ - i) * sizeof(DepthLevel));
+        levels_[i] = DepthLevel{price, total};
+        ++count_;
+    }
+
+    void rebuild(const BookSide<Compare>& book) {
+        count_ = 0;
+        book.forEachLevel([&](const PriceLevel& level) {
+            if (count_ == levels_.size()) {
+                return false;
+            }
+            levels_[count_++] = DepthLevel{level.price, level.totalQuantity};
+            return true;
+        });
+    }
+
+private:
+    void refillBack(const BookSide<Compare>& book) {
+        const PriceLevel* next;
+        if (count_ == 0) {
+            next = book.best();
+        } else {
+            const PriceLevel* last = book.find(levels_[count_ - 1].price);
+            if (last == nullptr) {
+                rebuild(book);  // Window out of step with the book: resync
+                return;
+            }
+            next = book.next(*last);
+        }
+        if (next != nullptr) {
+            levels_[count_++] = DepthLevel{next->price, next->totalQuantity};
+        }
+    }
+
+    std::vector<DepthLevel> levels_;
+    size_t count_ = 0;
+};
+
+} // namespace LOB
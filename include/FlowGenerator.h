@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Order.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace LOB {
+
+// Shape of the synthetic order flow; the defaults approximate a liquid equity book
+struct FlowConfig {
+    uint64_t seed = 42;
+    Price startPrice = 100000;     // Initial mid, in ticks
+    Price tickSize = 1;
+    double cancelRatio = 0.93;     // Cancels per add (cancel-to-order ratio)
+    double modifyShare = 0.02;     // Fraction of events that amend a resting order's size
+    double marketShare = 0.005;    // Fraction of events that are sweeping market orders
+    double aggressiveShare = 0.01; // Fraction of adds sent as marketable IOC orders
+    double touchConcentration = 0.35;  // Geometric p of a passive add's distance behind the touch
+    size_t maxLevelsOut = 50;      // Farthest passive placement, in ticks from the touch
+    double midStepProbability = 0.01;  // Per event: the mid random-walks one tick
+    Quantity lotSize = 100;        // Median passive size
+    Quantity sweepLots = 10;       // Market orders take up to this many lots
+    double burstProbability = 0.002;  // Per event: start a quote-flicker burst
+    size_t burstLength = 64;          // Cancel/replace pairs per burst
+    size_t maxResting = 10000;        // Live orders tracked; beyond this adds are paired with cancels
+};
+
+// Deterministic synthetic order flow for replay and capacity runs. Streams events one at
+// a time (no buffering), so day-scale runs cost O(maxResting) memory. Adds cluster
+// geometrically near a random-walking mid; most adds are cancelled, usually soon after
+// placement, and recent quotes the mid moves onto are pulled straight away; bursts move
+// the mid a tick and re-quote the near levels in a tight cancel/replace run; occasional
+// market orders sweep several levels.
+// Emits LIMIT/IOC/MARKET adds, CANCEL and MODIFY events as Orders for OrderBook::addOrder().
+// The generator does not see fills, so some cancels and amends target orders that have
+// already traded, as they do in real feeds.
+class FlowGenerator {
+public:
+    explicit FlowGenerator(const FlowConfig& config = FlowConfig());
+
+    Order next();
+    uint64_t eventCount() const { return events_; }
+    Price mid() const { return mid_; }
+
+private:
+    struct LiveOrder {
+        OrderId id;
+        Side side;
+        Price price;
+    };
+
+    Order makeAdd(Side side, bool aggressive);
+    Order makeCancel(bool recentBias);
+    Order makeModify();
+    size_t pickLive(bool recentBias);
+    Side randomSide() { return (rng_() & 1) ? Side::BUY : Side::SELL; }
+    // Hand-rolled rather than <random> distributions so a seed gives the same flow on every standard library
+    double uniform() { return static_cast<double>(rng_() >> 11) * 0x1.0p-53; }
+    size_t geometric(double logFailure);
+    void stepMid(int direction);
+
+    FlowConfig config_;
+    std::mt19937_64 rng_;
+    double placementLog_;  // log(1 - touchConcentration)
+    double recencyLog_;
+    std::vector<LiveOrder> live_;  // Orders the generator believes are resting, roughly oldest first
+    std::vector<LiveOrder> stale_;  // Quotes the mid moved onto, cancelled before anything else
+    OrderId nextId_;
+    Price mid_;
+    uint64_t events_;
+    uint64_t adds_;     // LIMIT, IOC and MARKET events emitted
+    uint64_t cancels_;  // Including stale pulls and burst cancels
+    size_t burstRemaining_;
+    bool burstCancelNext_;
+    Side burstSide_;
+};
+
+} // namespace LOB
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "BookSide.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Hot-path instrumentation is compiled in only with LOB_ENABLE_STATS (CMake option of the
+// same name). Without it LOB_STATS(...) expands to nothing and OrderBook carries no stats
+// members, so the instrumented paths are byte-for-byte the uninstrumented ones.
+#if defined(LOB_ENABLE_STATS)
+#define LOB_STATS(...) __VA_ARGS__
+#else
+#define LOB_STATS(...)
+#endif
+
+namespace LOB {
+
+// Raw timestamp counter: TSC on x86, the virtual counter on AArch64, steady_clock elsewhere
+inline uint64_t readCycleCounter() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Counter ticks per nanosecond, calibrated once against steady_clock (~5ms on first use)
+inline double ticksPerNanosecond() {
+    static const double rate = [] {
+        auto wallStart = std::chrono::steady_clock::now();
+        uint64_t tickStart = readCycleCounter();
+        while (std::chrono::steady_clock::now() - wallStart < std::chrono::milliseconds(5)) {
+        }
+        uint64_t ticks = readCycleCounter() - tickStart;
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wallStart).count();
+        return ns > 0 ? static_cast<double>(ticks) / ns : 1.0;
+    }();
+    return rate;
+}
+
+// Point-in-time copy of a LogLinearHistogram
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    double mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+    // Lower bound of the bucket holding the q-quantile (q in [0, 1])
+    uint64_t percentile(double q) const;
+};
+
+// Log-linear histogram: exact below 16, then 16 linear sub-buckets per power of two
+// (<= 6.25% relative error) up to 2^64. Single writer (the thread driving the book)
+// with plain relaxed load/store, no locked RMW on the hot path. Scrapers read relaxed
+// and "reset" by moving a baseline, so a reset never races with the writer's stores;
+// snapshot(true) is meant for one scraping thread. The max is the exception, since it
+// cannot be baselined: the scraper swaps it to 0 and the writer raises it with a CAS,
+// paid only when a value beats the current max. A value recorded during a scrape may
+// show in one window's max and the next window's counts, but is never lost.
+class LogLinearHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    LogLinearHistogram() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        baseline_.fill(0);
+        sumBaseline_ = 0;
+    }
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < SUB_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        unsigned exponent = 63u - countLeadingZeros(value);
+        size_t sub = static_cast<size_t>(value >> (exponent - SUB_BITS)) & (SUB_COUNT - 1);
+        return (exponent - SUB_BITS + 1) * SUB_COUNT + sub;
+    }
+
+    // Smallest value that maps to bucket i
+    static uint64_t bucketLowerBound(size_t i) {
+        if (i < SUB_COUNT) {
+            return i;
+        }
+        unsigned exponent = static_cast<unsigned>(i / SUB_COUNT) + SUB_BITS - 1;
+        return (uint64_t(SUB_COUNT) | (i % SUB_COUNT)) << (exponent - SUB_BITS);
+    }
+
+    // Writer thread only
+    void record(uint64_t value) {
+        std::atomic<uint64_t>& bucket = buckets_[bucketOf(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            // max was reloaded: a scraper reset it in between
+        }
+    }
+
+    // Counts since the last reset; with takeAndReset the next snapshot starts from here
+    HistogramSnapshot snapshot(bool takeAndReset = false) {
+        HistogramSnapshot snap;
+        snap.buckets.resize(BUCKET_COUNT);
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            uint64_t total = buckets_[i].load(std::memory_order_relaxed);
+            snap.buckets[i] = total - baseline_[i];
+            snap.count += snap.buckets[i];
+            if (takeAndReset) {
+                baseline_[i] = total;
+            }
+        }
+        uint64_t sum = sum_.load(std::memory_order_relaxed);
+        snap.sum = sum - sumBaseline_;
+        snap.max = takeAndReset ? max_.exchange(0, std::memory_order_relaxed) : max_.load(std::memory_order_relaxed);
+        if (takeAndReset) {
+            sumBaseline_ = sum;
+        }
+        return snap;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+    // Scraper-owned
+    std::array<uint64_t, BUCKET_COUNT> baseline_;
+    uint64_t sumBaseline_;
+};
+
+inline uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return LogLinearHistogram::bucketLowerBound(i);
+        }
+    }
+    return max;
+}
+
+// Scrapeable view of a book's instrumentation (all empty when compiled out)
+struct StatsSnapshot {
+    bool enabled = false;
+    double ticksPerNs = 1.0;          // Convert the *Ticks histograms to nanoseconds
+    HistogramSnapshot addOrderTicks;
+    HistogramSnapshot cancelOrderTicks;
+    HistogramSnapshot modifyOrderTicks;
+    HistogramSnapshot matchTicks;     // Aggressive orders only (touched at least one level)
+    HistogramSnapshot levelsWalked;   // Per aggressive order
+    HistogramSnapshot ordersFilled;   // Resting orders hit per aggressive order
+};
+
+// Bytes held by each part of a book (reserved capacity, map nodes estimated)
+struct MemoryUsage {
+    size_t levelBytes = 0;   // Ladders, overflow maps and depth caches
+    size_t orderBytes = 0;   // Order node pool
+    size_t indexBytes = 0;   // Id index slots and per-owner list heads
+    size_t tradeBytes = 0;   // Recorded trades or trade ring
+    size_t stopBytes = 0;    // Pending stop orders (nodes, index and trigger levels)
+
+    size_t total() const { return levelBytes + orderBytes + indexBytes + tradeBytes + stopBytes; }
+};
+
+} // namespace LOB
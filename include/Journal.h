@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Order.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LOB {
+
+// Inbound event kinds, one per public OrderBook entry point
+enum class JournalEventType : uint8_t {
+    ADD = 1,     // addOrder() (limit, market, or CANCEL/MODIFY typed orders)
+    CANCEL = 2,  // cancelOrder()
+    MODIFY = 3,  // modifyOrder()
+    MASS_CANCEL = 4,  // massCancel(): side holds the side mask, price/quantity the price range
+    START_AUCTION = 5,  // startAuction()
+    UNCROSS = 6,        // uncross()
+    STATE_HASH = 7      // OrderBook::stateHash() after the events before it, in orderId
+};
+
+// Fixed 48-byte little-endian record; replay reads these in place from the mapped file
+struct JournalRecord {
+    uint8_t eventType;
+    uint8_t side;
+    uint8_t orderType;
+    uint8_t reserved;
+    int32_t stopOffset;  // ADD of a STOP_LIMIT: trigger minus price, low half (see journalStopPrice)
+    uint64_t orderId;
+    int64_t price;
+    uint64_t quantity;
+    uint64_t sequence;  // Book timestamp when the event arrived (replay cross-check)
+    uint32_t owner;     // ADD and MASS_CANCEL
+    uint32_t stopOffsetHigh;  // ADD of a STOP_LIMIT: what stopOffset's sign extension leaves
+};
+static_assert(sizeof(JournalRecord) == 48, "JournalRecord must stay 48 bytes");
+
+// A mass cancel's inclusive price range rides in the price and quantity fields
+inline void setJournalPriceRange(JournalRecord& record, Price low, Price high) {
+    record.price = low;
+    record.quantity = static_cast<uint64_t>(high);
+}
+
+inline Price journalRangeHigh(const JournalRecord& record) {
+    return static_cast<Price>(record.quantity);
+}
+
+// Stop triggers ride in the record without widening it: a STOP journals its trigger as the
+// price, a STOP_LIMIT keeps its limit price plus the trigger offset split over stopOffset
+// and stopOffsetHigh, so every trigger round-trips. Records whose offset fits stopOffset
+// leave stopOffsetHigh 0, as journals from before the split did.
+inline void setJournalStop(JournalRecord& record, OrderType type, Price stopPrice) {
+    if (type == OrderType::STOP) {
+        record.price = stopPrice;
+    } else if (type == OrderType::STOP_LIMIT) {
+        // Unsigned, so that offsets past the int64 range wrap instead of overflowing
+        uint64_t offset = static_cast<uint64_t>(stopPrice) - static_cast<uint64_t>(record.price);
+        record.stopOffset = static_cast<int32_t>(static_cast<uint32_t>(offset));
+        record.stopOffsetHigh = static_cast<uint32_t>((offset - static_cast<uint64_t>(record.stopOffset)) >> 32);
+    }
+}
+
+inline Price journalStopPrice(const JournalRecord& record) {
+    return static_cast<Price>(static_cast<uint64_t>(record.price) + static_cast<uint64_t>(record.stopOffset) +
+                              (static_cast<uint64_t>(record.stopOffsetHigh) << 32));
+}
+
+// File header preceding the records
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+static_assert(sizeof(JournalHeader) == 16, "JournalHeader must stay 16 bytes");
+
+constexpr char JOURNAL_MAGIC[8] = {'L', 'O', 'B', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t JOURNAL_VERSION = 3;  // 2: owner field and mass cancels (48-byte records); 3: full stop offsets
+
+enum class FsyncPolicy {
+    NEVER,        // Leave durability to the OS page cache
+    EVERY_BATCH   // fsync after each batched write
+};
+
+// Append-only writer: records are buffered and written in batches
+class JournalWriter {
+public:
+    JournalWriter() = default;
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    // Creates (truncates) the journal file; false on I/O failure
+    bool open(const std::string& path, size_t batchRecords = 256, FsyncPolicy fsync = FsyncPolicy::NEVER);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+
+    void append(const JournalRecord& record) {
+        buffer_.push_back(record);
+        if (buffer_.size() >= batchRecords_) {
+            flush();
+        }
+    }
+
+    // Write buffered records (and fsync if configured)
+    bool flush();
+
+    uint64_t recordCount() const { return recordCount_ + buffer_.size(); }
+
+private:
+    std::FILE* file_ = nullptr;
+    std::vector<JournalRecord> buffer_;
+    size_t batchRecords_ = 256;
+    FsyncPolicy fsync_ = FsyncPolicy::NEVER;
+    uint64_t recordCount_ = 0;
+};
+
+// Read-only view of a journal file, memory-mapped where the platform allows
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // False if the file is missing or not a journal
+    bool open(const std::string& path);
+    void close();
+
+    const JournalRecord* records() const { return records_; }
+    size_t size() const { return count_; }
+    const JournalRecord& operator[](size_t i) const { return records_[i]; }
+
+private:
+    MappedFile file_;
+    const JournalRecord* records_ = nullptr;
+    size_t count_ = 0;
+};
+
+} // namespace LOB
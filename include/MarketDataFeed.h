@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Order.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace LOB {
+
+// Book output kinds carried on the shared-memory feed
+enum class FeedEventType : uint8_t {
+    ADD = 1,     // Order rested: orderId, side, price, quantity, timestamp (its priority)
+    MODIFY = 2,  // Resting order amended in place: new price, quantity and priority timestamp
+    DELETE = 3,  // Resting order removed other than by a fill (cancel, mass cancel, repricing)
+    TRADE = 4,   // Fill: orderId buys from otherId at price for quantity; a resting order
+                 // reduced to zero by fills is gone without a DELETE
+    LEVEL = 5    // Aggregated level total after a change: side, price, quantity (0 = level gone)
+};
+
+// Fixed 56-byte event; with the slot stamp it fills exactly one cache line
+struct FeedEvent {
+    uint64_t sequence;  // Set by the publisher: 1, 2, 3, ... with no gaps
+    uint8_t type;       // FeedEventType
+    uint8_t side;       // Side (ADD, MODIFY, DELETE, LEVEL)
+    uint16_t reserved;
+    uint32_t instrument;  // As given to OrderBook::setMarketDataFeed
+    uint64_t orderId;
+    uint64_t otherId;     // TRADE: sell order id
+    int64_t price;
+    uint64_t quantity;
+    uint64_t timestamp;   // Book priority clock when the event happened
+};
+static_assert(sizeof(FeedEvent) == 56, "FeedEvent must stay 56 bytes");
+
+// Start of the shared-memory region; the slot array follows at FEED_SLOTS_OFFSET
+struct FeedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t capacity;  // Slots, a power of two
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> published;  // Sequence of the last complete event
+};
+
+// One event per slot. stamp = 2 * sequence - 1 while the writer fills it and 2 * sequence
+// once complete; payload words are relaxed atomics so a reader racing the writer sees a
+// changed stamp rather than undefined behaviour (as in SeqlockTopOfBook)
+struct alignas(CACHE_LINE_SIZE) FeedSlot {
+    static constexpr size_t WORDS = sizeof(FeedEvent) / sizeof(uint64_t);
+    std::atomic<uint64_t> stamp;
+    std::atomic<uint64_t> words[WORDS];
+};
+static_assert(sizeof(FeedSlot) == CACHE_LINE_SIZE, "feed slot must fill exactly one cache line");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+constexpr char FEED_MAGIC[8] = {'L', 'O', 'B', 'F', 'E', 'E', 'D', '1'};
+constexpr uint32_t FEED_VERSION = 1;
+constexpr size_t FEED_SLOTS_OFFSET = 2 * CACHE_LINE_SIZE;
+static_assert(sizeof(FeedHeader) <= FEED_SLOTS_OFFSET, "feed header must fit before the slots");
+
+// Single writer of a broadcast ring in a named POSIX shared-memory object. The writer
+// never looks at readers: each publish is one slot write plus one counter store whatever
+// the number attached, and a reader that falls a full ring behind is overrun, not waited
+// for. Attach it to a book with OrderBook::setMarketDataFeed (from the book's thread).
+class MarketDataPublisher {
+public:
+    MarketDataPublisher() = default;
+    ~MarketDataPublisher();
+
+    MarketDataPublisher(const MarketDataPublisher&) = delete;
+    MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
+
+    // Creates (replacing) the object `name` ("/lob_feed") with capacity rounded up to a
+    // power of two; false if shared memory is unavailable (always on Windows)
+    bool create(const std::string& name, size_t capacity = 1 << 16);
+    // Unmaps, and removes the name so no new reader can attach; attached readers keep
+    // their mapping
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    void publish(FeedEvent event) {
+        uint64_t sequence = ++sequence_;
+        event.sequence = sequence;
+        FeedSlot& slot = slots_[sequence & mask_];
+        slot.stamp.store(2 * sequence - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t words[FeedSlot::WORDS];
+        std::memcpy(words, &event, sizeof(event));
+        for (size_t i = 0; i < FeedSlot::WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.stamp.store(2 * sequence, std::memory_order_release);
+        header_->published.store(sequence, std::memory_order_release);
+    }
+
+    uint64_t published() const { return sequence_; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::string name_;
+    FeedHeader* header_ = nullptr;
+    FeedSlot* slots_ = nullptr;
+    size_t mapSize_ = 0;
+    uint64_t mask_ = 0;
+    uint64_t sequence_ = 0;
+};
+
+enum class FeedStatus {
+    EVENT,   // `out` holds the next event
+    EMPTY,   // Nothing new yet
+    OVERRUN  // The writer lapped this reader: lost() events were skipped and the cursor
+             // moved to the oldest event still in the ring; poll again
+};
+
+// One consumer, in any process: maps the ring read-only and reads events in place from
+// the shared pages, tracking its own cursor. Readers never write shared state, so any
+// number can attach without the writer or each other noticing.
+class MarketDataReader {
+public:
+    MarketDataReader() = default;
+    ~MarketDataReader();
+
+    MarketDataReader(const MarketDataReader&) = delete;
+    MarketDataReader& operator=(const MarketDataReader&) = delete;
+
+    // Maps an existing feed; reading starts with the next event published. False if the
+    // name does not exist or is not a feed.
+    bool attach(const std::string& name);
+    void detach();
+    bool isAttached() const { return header_ != nullptr; }
+
+    FeedStatus poll(FeedEvent& out) {
+        const FeedSlot& slot = slots_[cursor_ & mask_];
+        uint64_t stamp = slot.stamp.load(std::memory_order_acquire);
+        if (stamp == 2 * cursor_) {
+            uint64_t words[FeedSlot::WORDS];
+            for (size_t i = 0; i < FeedSlot::WORDS; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.stamp.load(std::memory_order_relaxed) == stamp) {
+                std::memcpy(&out, words, sizeof(out));
+                ++cursor_;
+                return FeedStatus::EVENT;
+            }
+        } else if (stamp < 2 * cursor_) {
+            return FeedStatus::EMPTY;  // Older lap, or this sequence is being written
+        }
+        resync();
+        return FeedStatus::OVERRUN;
+    }
+
+    // Skips to the oldest event still in the ring (replaying what it holds)
+    void rewind();
+    uint64_t cursor() const { return cursor_; }  // Sequence of the next event to read
+    uint64_t lost() const { return lost_; }      // Events skipped by overruns so far
+    uint64_t published() const { return header_->published.load(std::memory_order_acquire); }
+
+private:
+    void resync();
+
+    const FeedHeader* header_ = nullptr;
+    const FeedSlot* slots_ = nullptr;
+    size_t mapSize_ = 0;
+    uint64_t mask_ = 0;
+    uint64_t cursor_ = 1;
+    uint64_t lost_ = 0;
+};
+
+} // namespace LOB
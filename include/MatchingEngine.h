@@ -0,0 +1,132 @@
+#pragma once
+
+#include "OrderBook.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace LOB {
+
+using SymbolId = uint32_t;
+
+enum class EngineEventType : uint8_t {
+    ADD,     // addOrder()
+    CANCEL,  // cancelOrder(order.id)
+    MODIFY,  // modifyOrder(order.id, order.price, order.quantity)
+    MASS_CANCEL,  // massCancel(order.owner): every order of that owner on the symbol
+    START_AUCTION,  // startAuction()
+    UNCROSS         // uncross()
+};
+
+struct EngineEvent {
+    SymbolId symbol = 0;
+    EngineEventType type = EngineEventType::ADD;
+    Order order{0, Side::BUY, OrderType::LIMIT, 0, 0, 0};
+};
+
+struct MatchingEngineConfig {
+    size_t shardCount = 0;           // 0 = one shard per hardware thread
+    size_t queueCapacity = 1 << 16;  // Per-shard inbound ring (rounded up to a power of two)
+    size_t batchSize = 256;          // Max events a shard drains per poll
+    bool pinThreads = true;          // Pin shard i to core i (Linux only)
+    OrderBookConfig bookConfig;      // Applied to every book
+};
+
+// Per-symbol and per-shard load, for rebalancing between sessions
+struct SymbolLoad {
+    SymbolId symbol;
+    size_t shard;
+    uint64_t events;
+};
+
+struct ShardLoad {
+    size_t shard;
+    size_t symbols;
+    uint64_t events;
+    uint64_t batches;
+    size_t queueDepth;
+};
+
+// Multi-symbol engine: each symbol's OrderBook is owned by exactly one shard, and each
+// shard runs on its own (optionally pinned) thread fed by its own SPSC queue, so the
+// matching path takes no locks. submit() must be called from a single producer thread.
+class MatchingEngine {
+public:
+    explicit MatchingEngine(const MatchingEngineConfig& config = MatchingEngineConfig());
+    ~MatchingEngine();
+
+    MatchingEngine(const MatchingEngine&) = delete;
+    MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+    // Symbol placement (before start()); addSymbol picks the least-populated shard
+    bool addSymbol(SymbolId symbol);
+    bool assignSymbol(SymbolId symbol, size_t shard);
+
+    void start();
+    // Drains every queue, then joins the shard threads
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Producer side: false if the symbol is unknown or its shard's queue is full
+    bool submit(const EngineEvent& event);
+    // Producer side: queue a MASS_CANCEL for the owner on every symbol (session dropped).
+    // Returns the number of symbols it was queued for; mass cancels are idempotent, so on a
+    // full queue simply call again until it reaches getSymbolCount().
+    size_t cancelOnDisconnect(OwnerId owner);
+    size_t getSymbolCount() const { return routes_.size(); }
+
+    size_t getShardCount() const { return shards_.size(); }
+    size_t getShardOf(SymbolId symbol) const;
+    // Book access is only safe while the engine is stopped
+    OrderBook* getBook(SymbolId symbol);
+
+    std::vector<ShardLoad> getShardLoads() const;
+    std::vector<SymbolLoad> getSymbolLoads() const;
+    // Greedy longest-processing-time placement of symbols by observed load
+    std::vector<std::pair<SymbolId, size_t>> planRebalance() const;
+
+private:
+    struct ShardEvent {
+        OrderBook* book = nullptr;
+        uint32_t symbolSlot = 0;
+        EngineEventType type = EngineEventType::ADD;
+        Order order{0, Side::BUY, OrderType::LIMIT, 0, 0, 0};
+    };
+
+    struct Symbol {
+        SymbolId id;
+        std::unique_ptr<OrderBook> book;
+        std::atomic<uint64_t> events{0};  // Written only by the owning shard
+    };
+
+    struct Shard {
+        explicit Shard(size_t queueCapacity) : queue(queueCapacity) {}
+
+        SpscQueue<ShardEvent> queue;
+        std::vector<std::unique_ptr<Symbol>> symbols;
+        std::thread thread;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> batches{0};
+    };
+
+    struct Route {
+        size_t shard;
+        uint32_t symbolSlot;
+        OrderBook* book;
+    };
+
+    void runShard(size_t shardIndex);
+    static void apply(const ShardEvent& event);
+
+    MatchingEngineConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unordered_map<SymbolId, Route> routes_;  // Producer-side routing only
+    std::atomic<bool> stopRequested_;
+    bool running_;
+};
+
+} // namespace LOB
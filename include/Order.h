@@ -8,6 +8,8 @@ namespace LOB {
 using OrderId = uint64_t;
 using Price = int64_t;  // Price in ticks (e.g., cents)
 using Quantity = uint64_t;
+using OwnerId = uint32_t;  // Participant / session that entered the order
+constexpr OwnerId NO_OWNER = 0;  // Not tracked for mass cancel
 
 enum class Side {
     BUY,
@@ -18,7 +20,11 @@ enum class OrderType {
     LIMIT,
     MARKET,
     CANCEL,
-    MODIFY
+    MODIFY,
+    IOC,  // Limit order; any unfilled remainder is cancelled instead of resting
+    FOK,  // Limit order filled in full immediately, or rejected without trading
+    STOP,       // Market order held until a trade prints at or through stopPrice
+    STOP_LIMIT  // Limit order at price held until a trade prints at or through stopPrice
 };
 
 struct Order {
@@ -28,9 +34,13 @@ struct Order {
     Price price;
     Quantity quantity;
     uint64_t timestamp;  // For time priority
+    Price stopPrice;     // STOP / STOP_LIMIT trigger: buy stops fire at last >= stopPrice, sell at <=
+    OwnerId owner;       // Resting and pending orders are listed per owner for massCancel()
 
-    Order(OrderId id, Side side, OrderType type, Price price, Quantity quantity, uint64_t timestamp)
-        : id(id), side(side), type(type), price(price), quantity(quantity), timestamp(timestamp) {}
+    Order(OrderId id, Side side, OrderType type, Price price, Quantity quantity, uint64_t timestamp,
+          Price stopPrice = 0, OwnerId owner = NO_OWNER)
+        : id(id), side(side), type(type), price(price), quantity(quantity), timestamp(timestamp),
+          stopPrice(stopPrice), owner(owner) {}
 };
 
 // Trade execution record
@@ -44,5 +54,8 @@ struct Trade {
     Trade(OrderId buyId, OrderId sellId, Price p, Quantity q, uint64_t ts)
         : buyOrderId(buyId), sellOrderId(sellId), price(p), quantity(q), timestamp(ts) {}
 };
+// Every field is read by every trade sink, so there is no cold part to split off;
+// keep it free of padding
+static_assert(sizeof(Trade) == 40, "Trade must stay five unpadded 8-byte fields");
 
 } // namespace LOB
@@ -1,9 +1,19 @@
 #pragma once
 
 #include "Order.h"
-#include <list>
+#include "OrderPool.h"
+#include "BookSide.h"
+#include "OrderIndex.h"
+#include "TradeSink.h"
+#include "DepthCache.h"
+#include "OrderPolicy.h"
+#include "Instrumentation.h"
+#include "TopOfBook.h"
+#include "StopBook.h"
+#include "Journal.h"
+#include "MarketDataFeed.h"
 #include <map>
-#include <unordered_map>
+#include <string>
 #include <vector>
 #include <memory>
 #include <optional>
@@ -11,72 +21,469 @@
 
 namespace LOB {
 
-// A price level contains a FIFO queue of orders (doubly linked list for O(1) erase)
-struct PriceLevel {
+// Combined outcome of processBatch()
+struct BatchResult {
+    size_t events = 0;
+    uint64_t fills = 0;
+    bool bidsChanged = false;  // Any resting bid added, removed, filled or amended
+    bool asksChanged = false;
+};
+
+// One level of a market maker's quote ladder; id is used only if the price needs a new order
+struct QuoteLevel {
     Price price;
-    std::list<Order> orders;
-    Quantity totalQuantity;
+    Quantity quantity;  // 0 = no quote at this price
+    OrderId id;
+};
+
+// What replaceQuotes() did to the owner's resting orders
+struct QuoteReplaceResult {
+    size_t unchanged = 0;  // Same price and size: untouched, priority kept
+    size_t amended = 0;    // Same price, new size: amended in place
+    size_t added = 0;      // Newly quoted price
+    size_t cancelled = 0;  // Price no longer quoted, or a second order at a quoted price
+    size_t rejected = 0;   // New price not quoted: its id is already live (see addOrder)
+};
+
+// Equilibrium of a call auction: what uncross() executed, or would execute now
+struct AuctionResult {
+    bool crossed = false;        // Bids and asks overlapped, so something executes
+    Price price = 0;             // Every auction fill prints here
+    Quantity volume = 0;         // Executable at price
+    Quantity imbalance = 0;      // Surplus left unfilled on imbalanceSide at price
+    Side imbalanceSide = Side::BUY;
+    uint64_t trades = 0;         // uncross() only
+};
+
+// Construction-time sizing options
+struct OrderBookConfig {
+    size_t orderPoolCapacity = 1 << 16;  // Resting orders preallocated in the node pool and id index
+
+    // Ladder mode: contiguous tick-indexed levels around the mid (0 = map only)
+    size_t ladderLevels = 0;
+    Price ladderTickSize = 1;
+    std::optional<Price> ladderBasePrice;  // Lowest ladder price; centred on the first resting order if unset
+
+    // Trade output (RECORD keeps the full history available through getTrades())
+    TradeSinkMode tradeSink = TradeSinkMode::RECORD;
+    TradeCallback tradeCallback = nullptr;  // CALLBACK mode
+    void* tradeCallbackContext = nullptr;
+    size_t tradeRingCapacity = 4096;        // RING mode (rounded up to a power of two)
+    RingPolicy tradeRingPolicy = RingPolicy::OVERWRITE;
 
-    PriceLevel(Price p) : price(p), totalQuantity(0) {}
+    // Fenwick tree over each side's ladder level totals: getCumulativeVolume() and FOK
+    // checks in O(log N) for ladder prices (ladder mode only; otherwise levels are walked)
+    bool prefixVolumes = false;
+
+    // Market data: top-N aggregated levels per side for getDepth() (0 = off), and an
+    // optional per-level delta feed covering every level change at any depth
+    size_t depthLevels = 0;
+    DepthCallback depthCallback = nullptr;
+    void* depthCallbackContext = nullptr;
+
+    // Publish best bid/ask and their sizes through a seqlock after every event that
+    // changes them, for lock-free reads from other threads via getTopOfBook()
+    bool publishTopOfBook = false;
+
+    // Replica check: keep stateHash() current through every resting-order change, and
+    // while a journal is attached append a STATE_HASH record every N events (0 = never)
+    bool trackStateHash = false;
+    size_t stateHashInterval = 0;
+
+    // CALLBACK mode bound to a listener object with `void onTrade(const Trade&)`
+    template<typename Listener>
+    void setTradeListener(Listener& listener) {
+        tradeSink = TradeSinkMode::CALLBACK;
+        tradeCallback = makeTradeCallback<Listener>();
+        tradeCallbackContext = &listener;
+    }
 };
 
 class OrderBook {
 public:
-    OrderBook();
+    explicit OrderBook(const OrderBookConfig& config = OrderBookConfig());
     ~OrderBook() = default;
 
-    // Core operations
-    void addOrder(const Order& order);
+    // Core operations. STOP / STOP_LIMIT orders wait in a separate trigger book until a
+    // trade prints at or through their stopPrice (immediately if the last trade already
+    // has), then enter matching as MARKET / LIMIT orders. Pending stops can be cancelled
+    // (or modified to quantity 0) but not amended. Ids are unique among live orders: an
+    // order whose id is already resting or pending as a stop is rejected untouched and
+    // counted by getRejectedCount(). Returns false if rejected (or, for a CANCEL / MODIFY
+    // typed order, if its target was not found).
+    bool addOrder(const Order& order);
     bool cancelOrder(OrderId orderId);
+    // Amend in place: a same-price size reduction keeps time priority, a size increase or
+    // passive price change requeues the order at the back, and only a marketable new price
+    // re-enters matching. Quantity 0 cancels.
     bool modifyOrder(OrderId orderId, Price newPrice, Quantity newQuantity);
+    // Pull every resting order and pending stop entered with this owner (cancel-on-disconnect,
+    // risk breach), optionally on one side and within an inclusive price range (stops match
+    // on their trigger). Walks only the owner's own list and settles each affected level
+    // once. Returns the number of orders removed.
+    size_t massCancel(OwnerId owner);
+    size_t massCancel(OwnerId owner, Side side);
+    size_t massCancel(OwnerId owner, Side side, Price low, Price high);
+    
+    // Call auction (opening / closing cross). While it runs, LIMIT orders rest without
+    // matching, so the book may cross; MARKET/IOC/FOK orders cannot rest and are dropped,
+    // and stops do not trigger. uncross() picks the price that maximises executable volume
+    // (then minimum imbalance, then the side of the surplus, then nearest the last trade)
+    // in one sweep over the crossed levels, fills everything executable there in
+    // price-time priority, and returns the book to continuous matching.
+    void startAuction();
+    AuctionResult uncross();
+    bool inAuction() const { return auction_; }
+    // What uncross() would execute now, without trading
+    AuctionResult getIndicativeUncross() const { return computeUncross(); }
+    
+    // Mass quote: make the owner's resting orders on each side exactly the given ladder (one
+    // order per price, any order). Prices quoted before and after are amended in place
+    // (a size cut keeps priority, see modifyOrder), so the work is proportional to the
+    // levels that changed, not the ladder size. Stale quotes are cancelled first, then
+    // sizes amended, then new prices added (matching if they cross). Applied as one event:
+    // top of book is published once. Journaled as its constituent cancels/amends/adds.
+    // A new price whose id is already live is skipped and counted as rejected.
+    QuoteReplaceResult replaceQuotes(OwnerId owner, const QuoteLevel* bids, size_t bidCount,
+                                     const QuoteLevel* asks, size_t askCount);
+    QuoteReplaceResult replaceQuotes(OwnerId owner, const std::vector<QuoteLevel>& bids,
+                                     const std::vector<QuoteLevel>& asks) {
+        return replaceQuotes(owner, bids.data(), bids.size(), asks.data(), asks.size());
+    }
+    
+    // Batch submission: same results as calling addOrder() on each event in turn, but index
+    // and level entries are prefetched ahead, consecutive cancels are grouped, and one
+    // combined result is produced for the whole batch
+    BatchResult processBatch(const Order* orders, size_t count);
+    BatchResult addOrders(const std::vector<Order>& orders) { return processBatch(orders.data(), orders.size()); }
     
     // Market data queries
     std::optional<Price> getBestBid() const;
     std::optional<Price> getBestAsk() const;
     std::optional<Quantity> getVolumeAtPrice(Side side, Price price) const;
+    // Quantity resting at limitPrice or better: bids priced >= limitPrice for BUY,
+    // asks priced <= limitPrice for SELL
+    Quantity getCumulativeVolume(Side side, Price limitPrice) const;
+    // Copies up to maxLevels of the cached top-N levels (best first); returns the count
+    size_t getDepth(Side side, DepthLevel* out, size_t maxLevels) const;
+    // Price of the most recent trade (drives STOP / STOP_LIMIT triggers)
+    std::optional<Price> getLastTradePrice() const {
+        return hasLastTrade_ ? std::optional<Price>(lastTradePrice_) : std::nullopt;
+    }
+    // Last published top of book (publishTopOfBook only). Safe from any thread while the
+    // book runs; never blocks the writer.
+    TopOfBook getTopOfBook() const { return topOfBook_.read(); }
+    // Order-independent 64-bit hash of the resting orders (id, side, price, remaining
+    // quantity, priority), updated in O(1) per change (trackStateHash only, else 0). Books
+    // with equal hashes hold the same resting orders in the same queue order, barring a
+    // 2^-64 collision. Pending stops are not included.
+    uint64_t stateHash() const { return stateHash_; }
+    // The same value recomputed from every resting order, O(N), with or without tracking
+    uint64_t computeStateHash() const;
     
-    // Trade history
+    // Trade history (RECORD sink only)
     const std::vector<Trade>& getTrades() const { return trades_; }
+    void clearTrades() { trades_.clear(); }
+    // Trade ring (RING sink only, nullptr otherwise)
+    TradeRing* getTradeRing() { return tradeRing_.get(); }
+    uint64_t getTradeCount() const { return tradeCount_; }
+    uint64_t getRejectedCount() const { return rejectedCount_; }  // Orders refused at entry
+    
+    // Event journal: every inbound add/cancel/modify is appended (nullptr detaches)
+    void setJournal(JournalWriter* journal) { journal_ = journal; }
+    // Feed journal records straight into the matching engine; returns the number applied
+    // (stops early if a record's sequence does not match this book's timestamp, or, with
+    // trackStateHash, at a STATE_HASH record this book's stateHash() disagrees with)
+    size_t replay(const JournalRecord* records, size_t count);
+    size_t replay(const JournalReader& reader) { return replay(reader.records(), reader.size()); }
+    uint64_t getTimestamp() const { return timestamp_; }
+    
+    // Shared-memory market data: every order add/amend/delete, fill and level change is
+    // published as it happens, tagged with `instrument` (nullptr detaches). The book's
+    // thread becomes the feed's single writer. A snapshot load publishes nothing:
+    // consumers resync from the book.
+    void setMarketDataFeed(MarketDataPublisher* feed, uint32_t instrument = 0) {
+        feed_ = feed;
+        feedInstrument_ = instrument;
+    }
+    
+    // Flat binary snapshot of all resting orders (level and FIFO order) plus the priority clock.
+    // loadSnapshot replaces the current state in one linear pass; false on I/O or format error.
+    bool saveSnapshot(const std::string& path) const;
+    bool loadSnapshot(const std::string& path);
+    
+    // Pre-size order storage and the id index so no rehash happens mid-session
+    void reserve(size_t orderCount);
+    size_t capacity() const { return orderIndex_.capacity(); }
     
     // Statistics
     size_t getOrderCount() const { return orderIndex_.size(); }
+    size_t getStopCount() const { return stops_.size(); }  // Pending, not yet triggered
+    // Resting orders plus pending stops entered with this owner
+    size_t getOwnerOrderCount(OwnerId owner) const { return owners_.count(owner) + stops_.ownerCount(owner); }
+    // Hot-path timers and histograms (LOB_ENABLE_STATS builds; otherwise empty with
+    // enabled = false). Both may be called from another thread while the book runs.
+    StatsSnapshot getStats() const;
+    StatsSnapshot resetStats();  // Snapshot and zero in one pass
+    // Bytes held by levels, order storage, id index and owner lists, trades and pending stops
+    // (same thread as the book)
+    MemoryUsage getMemoryUsage() const;
     void printBook(int depth = 10) const;
 
 private:
-    // Dual-structure approach for O(1) lookup + O(log N) ordered access
+    // Dual-structure approach for O(1) lookup + ordered access
+    // (tick ladder in the band around the mid, O(log N) map outside it)
     // Bids: Higher price has priority (descending order)
-    std::map<Price, PriceLevel, std::greater<Price>> bids_;
+    BookSide<std::greater<Price>> bids_;
     // Asks: Lower price has priority (ascending order)
-    std::map<Price, PriceLevel, std::less<Price>> asks_;
+    BookSide<std::less<Price>> asks_;
+
+    // Ladder sizing, applied lazily when the first order rests
+    size_t ladderLevels_;
+    Price ladderTickSize_;
+    std::optional<Price> ladderBasePrice_;
     
-    // O(1) order lookup: maps OrderId -> (list iterator, price level, side)
-    struct OrderLocation {
-        std::list<Order>::iterator orderIt;
-        Price priceLevel;
-        Side side;
+    // Preallocated storage for every resting order
+    OrderPool pool_;
+
+    // O(1) order lookup: maps OrderId -> (pool node, owning price level)
+    OrderIndex orderIndex_;
+
+    // Owned resting orders per owner, threaded through the pool's cold array
+    OwnerLists owners_;
+    // Mass cancel scratch: quantity removed per touched level, in a flat open-addressing
+    // table keyed by level address and sized from the owner's order count, so every level
+    // is settled once without sorting
+    struct LevelRemoval {
+        PriceLevel* level;
+        Quantity quantity;
+    };
+    std::vector<LevelRemoval> bidRemovals_;
+    std::vector<LevelRemoval> askRemovals_;
+
+    // replaceQuotes scratch: the owner's current quotes and the wanted ladder per side,
+    // each sorted by price (current quotes then by priority)
+    struct CurrentQuote {
+        Price price;
+        uint64_t timestamp;
+        OrderId id;
+        Quantity quantity;
     };
-    std::unordered_map<OrderId, OrderLocation> orderIndex_;
+    std::vector<CurrentQuote> currentBidQuotes_;
+    std::vector<CurrentQuote> currentAskQuotes_;
+    std::vector<QuoteLevel> wantedBidQuotes_;
+    std::vector<QuoteLevel> wantedAskQuotes_;
     
-    // Trade execution history
+    // Trade output
+    TradeSinkMode tradeSink_;
+    TradeCallback tradeCallback_;
+    void* tradeCallbackContext_;
+    std::unique_ptr<TradeRing> tradeRing_;
     std::vector<Trade> trades_;
+    uint64_t tradeCount_;
+    uint64_t rejectedCount_;
+    
+    // Incremental L2 depth and its delta feed
+    DepthSide<std::greater<Price>> bidDepth_;
+    DepthSide<std::less<Price>> askDepth_;
+    DepthCallback depthCallback_;
+    void* depthCallbackContext_;
+    bool trackDepth_;
+    
+    // Top of book as last published (writer-side copy, to skip unchanged publishes)
+    bool publishTop_;
+    TopOfBook lastTop_;
+    
+    // Pending stops and the trade price that fires them
+    StopBook stops_;
+    std::vector<Order> firedStops_;  // Cascade queue, reused between events
+    Price lastTradePrice_;
+    bool hasLastTrade_;
+    bool firingStops_;
+    
+    // Call auction phase: orders rest without matching until uncross()
+    bool auction_;
+    
+    // Optional inbound event journal (not owned)
+    JournalWriter* journal_;
+    
+    // Optional outbound market data feed (not owned)
+    MarketDataPublisher* feed_;
+    uint32_t feedInstrument_;
+    
+    // Resting-order state hash: the wrapping sum of orderStateHash() over resting orders,
+    // so a change subtracts the order's old term and adds its new one
+    bool hashState_;
+    uint64_t stateHash_;
+    size_t stateHashInterval_;
+    size_t eventsSinceHash_;
+    
+    // Sides touched since the last reset (bit 0 = bids, bit 1 = asks)
+    uint8_t changedSides_;
+    static uint8_t sideBit(Side side) { return side == Side::BUY ? 1 : 2; }
     
     // Timestamp counter for order priority
     uint64_t timestamp_;
 
-    // Internal matching engine
-    void matchLimitOrder(Order& order);
-    void matchMarketOrder(Order& order);
-    void executeTrade(Order& aggressor, Order& resting, Quantity quantity);
+#if defined(LOB_ENABLE_STATS)
+    // Written only by the thread driving the book; heap-allocated to keep its
+    // ~94KB of buckets off the book's own cache lines
+    struct Stats {
+        LogLinearHistogram addOrderTicks;
+        LogLinearHistogram cancelOrderTicks;
+        LogLinearHistogram modifyOrderTicks;
+        LogLinearHistogram matchTicks;
+        LogLinearHistogram levelsWalked;
+        LogLinearHistogram ordersFilled;
+    };
+    std::unique_ptr<Stats> stats_;
+    StatsSnapshot collectStats(bool takeAndReset) const;
+#endif
+
+    // Read by other threads: kept on its own cache line, away from the writer's state
+    SeqlockTopOfBook topOfBook_;
+
+    // Unjournaled entry points shared by the public API and replay
+    bool processOrder(const Order& order);
+    bool isLive(OrderId orderId) const {
+        return orderIndex_.find(orderId) != nullptr || (!stops_.empty() && stops_.contains(orderId));
+    }
+    bool processCancel(OrderId orderId);
+    bool processModify(OrderId orderId, Price newPrice, Quantity newQuantity);
+    size_t processMassCancel(OwnerId owner, uint8_t sides, Price low, Price high);
+    size_t massCancel(OwnerId owner, uint8_t sides, Price low, Price high);
+    static void tallyRemoval(std::vector<LevelRemoval>& removals, PriceLevel* level, Quantity quantity);
+    template<typename OrderSide>
+    void settleRemovals(std::vector<LevelRemoval>& removals);
+    void journalEvent(JournalEventType type, OrderId id, Side side, OrderType orderType,
+                      Price price, Quantity quantity, Price stopPrice = 0, OwnerId owner = NO_OWNER);
+    void fireStops();
+    enum class QuotePhase { CANCEL, AMEND, ADD };
+    void applyQuoteDiff(OwnerId owner, Side side, QuotePhase phase, QuoteReplaceResult& result);
+    void processStartAuction() { auction_ = true; }
+    AuctionResult processUncross();
+    AuctionResult computeUncross() const;
+    void executeUncross(Price price, Quantity volume);
+
+    // Internal matching engine, instantiated per side and order-type policy (OrderPolicy.h).
+    // The runtime side/type switch happens once per event in processOrder.
+    template<typename TypePolicy>
+    void dispatchOrder(Order& order);
+    template<typename OrderSide, typename TypePolicy>
+    void handleOrder(Order& order);
+    template<typename OrderSide, typename TypePolicy>
+    void matchAgainstBook(Order& order);
+    template<typename OrderSide>
+    bool canFillCompletely(const Order& order) const;
+    template<typename OrderSide>
+    bool wouldCross(Price price) const;
+    template<typename OrderSide>
+    void executeTrade(const Order& aggressor, OrderId restingId, Price tradePrice, Quantity quantity);
+    void recordTrade(OrderId buyId, OrderId sellId, Price tradePrice, Quantity quantity);
     
     // Helper methods
-    void addToBook(Order order);
-    void removeFromBook(OrderId orderId);
-    std::map<Price, PriceLevel, std::greater<Price>>& getBidBook() { return bids_; }
-    std::map<Price, PriceLevel, std::less<Price>>& getAskBook() { return asks_; }
-    
-    template<typename Comparator>
-    void matchAgainstBook(Order& order, std::map<Price, PriceLevel, Comparator>& book, 
-                          bool (*canMatch)(Price, Price));
+    template<typename OrderSide>
+    void addToBook(const Order& order);
+    template<typename OrderSide>
+    void removeFromBook(OrderIndex::Entry* entry);
+    void removeFromBook(OrderIndex::Entry* entry);
+    template<typename OrderSide>
+    bool amendOrder(OrderIndex::Entry* entry, Price newPrice, Quantity newQuantity);
+    void anchorLadder(Price price);
+    // Called after every level total change, with the book already updated
+    void levelChanged(Side side, Price price, Quantity total, DepthAction action) {
+        if (trackDepth_) {
+            publishLevel(side, price, total, action);
+        }
+        feedEvent(FeedEventType::LEVEL, side, 0, price, total, timestamp_);
+    }
+    void feedEvent(FeedEventType type, Side side, OrderId id, Price price, Quantity quantity, uint64_t timestamp,
+                   OrderId otherId = 0) {
+        if (feed_ != nullptr) {
+            FeedEvent event{};
+            event.type = static_cast<uint8_t>(type);
+            event.side = static_cast<uint8_t>(side);
+            event.instrument = feedInstrument_;
+            event.orderId = id;
+            event.otherId = otherId;
+            event.price = price;
+            event.quantity = quantity;
+            event.timestamp = timestamp;
+            feed_->publish(event);
+        }
+    }
+    void publishLevel(Side side, Price price, Quantity total, DepthAction action);
+    void rebuildDepth();
+    static uint64_t orderStateHash(OrderId id, Side side, Price price, Quantity quantity, uint64_t timestamp) {
+        auto mix = [](uint64_t x) {  // splitmix64 finalizer
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        };
+        uint64_t h = mix(id + 0x9E3779B97F4A7C15ull);
+        h = mix(h ^ static_cast<uint64_t>(price));
+        h = mix(h ^ (quantity << 1 | (side == Side::SELL ? 1 : 0)));
+        return mix(h ^ timestamp);
+    }
+    // Bracket every change to a resting order: hashOut with its old state, hashIn with its new
+    void hashOut(NodeHandle node, Price price) {
+        if (hashState_) {
+            const OrderNode& order = pool_[node];
+            stateHash_ -= orderStateHash(order.id, order.side, price, order.quantity, pool_.cold(node).timestamp);
+        }
+    }
+    void hashIn(NodeHandle node, Price price) {
+        if (hashState_) {
+            const OrderNode& order = pool_[node];
+            stateHash_ += orderStateHash(order.id, order.side, price, order.quantity, pool_.cold(node).timestamp);
+        }
+    }
+    void journalStateHash();
+    // Called once per completed event, never mid-event
+    void eventDone() {
+        if (publishTop_) {
+            publishTopOfBook();
+        }
+        if (stateHashInterval_ > 0 && journal_ != nullptr && ++eventsSinceHash_ >= stateHashInterval_) {
+            journalStateHash();
+        }
+    }
+    void publishTopOfBook();
+    void prefetchFor(const Order& order) const;
+
+    // Book selection resolved at compile time
+    template<typename OrderSide>
+    auto& ownBook() {
+        if constexpr (OrderSide::side == Side::BUY) {
+            return bids_;
+        } else {
+            return asks_;
+        }
+    }
+    template<typename OrderSide>
+    const auto& ownBook() const {
+        if constexpr (OrderSide::side == Side::BUY) {
+            return bids_;
+        } else {
+            return asks_;
+        }
+    }
+    template<typename OrderSide>
+    auto& oppositeBook() {
+        if constexpr (OrderSide::side == Side::BUY) {
+            return asks_;
+        } else {
+            return bids_;
+        }
+    }
+    template<typename OrderSide>
+    const auto& oppositeBook() const {
+        if constexpr (OrderSide::side == Side::BUY) {
+            return asks_;
+        } else {
+            return bids_;
+        }
+    }
 };
 
 } // namespace LOB
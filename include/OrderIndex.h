@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Order.h"
+#include "OrderPool.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace LOB {
+
+struct PriceLevel;
+
+// Flat open-addressing OrderId index (linear probing, backward-shift deletion).
+// Entries live inline in one array and point straight at the pool node and the
+// owning price level, so a cancel is a single probe followed by an O(1) unlink.
+// Deletion shifts the following cluster back instead of leaving tombstones, so
+// probe lengths do not degrade under add/cancel churn.
+class OrderIndex {
+public:
+    struct Entry {
+        OrderId id;
+        PriceLevel* level;
+        NodeHandle node;  // NULL_NODE marks an empty slot
+    };
+
+    explicit OrderIndex(size_t expectedOrders = 0) : size_(0) {
+        rehash(slotsFor(expectedOrders));
+    }
+
+    // Pre-size so that `orderCount` entries fit without a rehash
+    void reserve(size_t orderCount) {
+        size_t slots = slotsFor(orderCount);
+        if (slots > slots_.size()) {
+            rehash(slots);
+        }
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // Number of entries that fit before the next rehash
+    size_t capacity() const { return slots_.size() / 2; }
+    size_t bucketCount() const { return slots_.size(); }
+    size_t memoryBytes() const { return slots_.capacity() * sizeof(Entry); }
+
+    // Pull the home slot of id into cache ahead of a find/insert
+    void prefetch(OrderId id) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&slots_[bucketFor(id)]);
+#else
+        (void)id;
+#endif
+    }
+
+    Entry* find(OrderId id) {
+        size_t i = bucketFor(id);
+        while (true) {
+            Entry& slot = slots_[i];
+            if (slot.node == NULL_NODE) {
+                return nullptr;
+            }
+            if (slot.id == id) {
+                return &slot;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    const Entry* find(OrderId id) const { return const_cast<OrderIndex*>(this)->find(id); }
+
+    // Insert or overwrite the entry for id
+    Entry& insert(OrderId id, NodeHandle node, PriceLevel* level) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+        }
+        size_t i = bucketFor(id);
+        while (slots_[i].node != NULL_NODE && slots_[i].id != id) {
+            i = (i + 1) & mask_;
+        }
+        Entry& slot = slots_[i];
+        if (slot.node == NULL_NODE) {
+            ++size_;
+        }
+        slot.id = id;
+        slot.node = node;
+        slot.level = level;
+        return slot;
+    }
+
+    bool erase(OrderId id) {
+        Entry* entry = find(id);
+        if (entry == nullptr) {
+            return false;
+        }
+        erase(entry);
+        return true;
+    }
+
+    // Erase a slot returned by find(); pulls later cluster members back into the hole
+    void erase(Entry* entry) {
+        size_t hole = static_cast<size_t>(entry - slots_.data());
+        size_t i = hole;
+        while (true) {
+            i = (i + 1) & mask_;
+            Entry& slot = slots_[i];
+            if (slot.node == NULL_NODE) {
+                break;
+            }
+            size_t home = bucketFor(slot.id);
+            // Move back unless the slot's home lies cyclically in (hole, i]
+            bool homeInRange = hole <= i ? (home > hole && home <= i) : (home > hole || home <= i);
+            if (!homeInRange) {
+                slots_[hole] = slot;
+                hole = i;
+            }
+        }
+        slots_[hole].node = NULL_NODE;
+        --size_;
+    }
+
+    void clear() {
+        for (Entry& slot : slots_) {
+            slot.node = NULL_NODE;
+        }
+        size_ = 0;
+    }
+
+    template<typename Fn>
+    void forEach(Fn fn) const {
+        for (const Entry& slot : slots_) {
+            if (slot.node != NULL_NODE) {
+                fn(slot);
+            }
+        }
+    }
+
+private:
+    // Power-of-two table kept at most half full
+    static size_t slotsFor(size_t orderCount) {
+        size_t slots = 16;
+        while (slots < orderCount * 2) {
+            slots *= 2;
+        }
+        return slots;
+    }
+
+    size_t bucketFor(OrderId id) const {
+        // Fibonacci hashing spreads sequential ids across the table
+        return static_cast<size_t>((id * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void rehash(size_t slotCount) {
+        std::vector<Entry> old;
+        old.swap(slots_);
+        slots_.assign(slotCount, Entry{0, nullptr, NULL_NODE});
+        mask_ = slotCount - 1;
+        shift_ = 64;
+        for (size_t n = slotCount; n > 1; n >>= 1) {
+            --shift_;
+        }
+        size_ = 0;
+        for (const Entry& slot : old) {
+            if (slot.node != NULL_NODE) {
+                insert(slot.id, slot.node, slot.level);
+            }
+        }
+    }
+
+    std::vector<Entry> slots_;
+    size_t mask_;
+    unsigned shift_;
+    size_t size_;
+};
+
+} // namespace LOB
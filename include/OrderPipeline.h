@@ -0,0 +1,98 @@
+#pragma once
+
+#include "OrderBook.h"
+#include "SpscQueue.h"
+#include "WaitStrategy.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace LOB {
+
+// Inbound event: the order plus an opaque tag echoed back in its ack
+struct PipelineEvent {
+    Order order{0, Side::BUY, OrderType::LIMIT, 0, 0, 0};
+    uint64_t tag = 0;
+};
+
+enum class PipelineResultType : uint8_t {
+    ACK,   // One per inbound event, after it has been fully processed
+    FILL   // One per trade, emitted before the aggressor's ack
+};
+
+struct PipelineResult {
+    PipelineResultType type = PipelineResultType::ACK;
+    OrderId orderId = 0;
+    bool accepted = true;  // ACK: false if an add was rejected (live id) or a cancel/modify missed
+    uint64_t tag = 0;      // ACK: the inbound event's tag
+    Trade trade{0, 0, 0, 0, 0};  // FILL
+};
+
+struct PipelineConfig {
+    size_t producers = 1;             // One SPSC ingress ring per producer thread
+    size_t ingressCapacity = 1 << 16;
+    size_t egressCapacity = 1 << 16;
+    size_t batchSize = 256;           // Max events drained per ring per poll
+    WaitStrategy waitStrategy = WaitStrategy::SPIN;
+    int pinCore = -1;                 // Pin the matching thread (Linux only, -1 = no)
+    OrderBookConfig bookConfig;       // Trade sink is replaced by the egress ring
+};
+
+// Pipelined front end: producers push into padded lock-free SPSC rings, a dedicated
+// busy-polling matching thread drains them in batches into its OrderBook, and acks and
+// fills go out through a second SPSC ring to a single consumer.
+// LIMIT/MARKET/IOC/FOK/STOP/STOP_LIMIT orders go to addOrder, CANCEL to cancelOrder and MODIFY to modifyOrder.
+class OrderPipeline {
+public:
+    explicit OrderPipeline(const PipelineConfig& config = PipelineConfig());
+    ~OrderPipeline();
+
+    OrderPipeline(const OrderPipeline&) = delete;
+    OrderPipeline& operator=(const OrderPipeline&) = delete;
+
+    void start();
+    // Processes everything already submitted, then joins the matching thread
+    void stop();
+
+    // Producer `producer` only; false if its ring is full
+    bool submit(size_t producer, const PipelineEvent& event) {
+        if (!ingress_[producer]->tryPush(event)) {
+            return false;
+        }
+        waiter_.notify();
+        return true;
+    }
+
+    // Result consumer (single thread)
+    bool pollResult(PipelineResult& out) { return egress_.tryPop(out); }
+    template<typename Fn>
+    size_t drainResults(Fn fn, size_t maxCount = 1024) { return egress_.consumeBatch(maxCount, fn); }
+
+    // Safe only while stopped
+    OrderBook& book() { return *book_; }
+    // Any thread, also while running (bookConfig.publishTopOfBook)
+    TopOfBook topOfBook() const { return book_->getTopOfBook(); }
+    uint64_t getProcessedCount() const { return processed_.load(std::memory_order_relaxed); }
+    uint64_t getEgressStalls() const { return egressStalls_.load(std::memory_order_relaxed); }
+
+private:
+    static void onTrade(void* context, const Trade& trade);
+    void publish(const PipelineResult& result);
+    void process(const PipelineEvent& event);
+    bool hasInbound() const;
+    void run();
+
+    PipelineConfig config_;
+    std::unique_ptr<OrderBook> book_;
+    std::vector<std::unique_ptr<SpscQueue<PipelineEvent>>> ingress_;
+    SpscQueue<PipelineResult> egress_;
+    IdleWaiter waiter_;
+    std::thread thread_;
+    std::atomic<bool> stopRequested_;
+    std::atomic<uint64_t> processed_;
+    std::atomic<uint64_t> egressStalls_;
+    bool running_;
+};
+
+} // namespace LOB
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Order.h"
+#include <functional>
+
+namespace LOB {
+
+// Compile-time side policies: the matching, insertion and removal paths are instantiated
+// once per side, so book selection and price comparisons resolve statically.
+struct BuySide {
+    static constexpr Side side = Side::BUY;
+    static constexpr Side opposite = Side::SELL;
+    using Compare = std::greater<Price>;          // Own book: highest price first
+    using OppositeCompare = std::less<Price>;     // Resting asks: lowest price first
+
+    // A buy limit reaches a resting ask at or below it
+    static bool crosses(Price limit, Price resting) { return limit >= resting; }
+};
+
+struct SellSide {
+    static constexpr Side side = Side::SELL;
+    static constexpr Side opposite = Side::BUY;
+    using Compare = std::less<Price>;
+    using OppositeCompare = std::greater<Price>;
+
+    static bool crosses(Price limit, Price resting) { return limit <= resting; }
+};
+
+// Compile-time order-type policies for incoming (aggressing) orders
+struct LimitPolicy {
+    static constexpr bool priceLimited = true;
+    static constexpr bool restsRemainder = true;
+    static constexpr bool allOrNothing = false;
+};
+
+struct MarketPolicy {
+    static constexpr bool priceLimited = false;
+    static constexpr bool restsRemainder = false;  // Unfilled remainder is cancelled
+    static constexpr bool allOrNothing = false;
+};
+
+struct IocPolicy {
+    static constexpr bool priceLimited = true;
+    static constexpr bool restsRemainder = false;
+    static constexpr bool allOrNothing = false;
+};
+
+struct FokPolicy {
+    static constexpr bool priceLimited = true;
+    static constexpr bool restsRemainder = false;
+    static constexpr bool allOrNothing = true;
+};
+
+} // namespace LOB
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Order.h"
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace LOB {
+
+// Stable handle to a pooled order node (index into the pool, survives pool growth)
+using NodeHandle = uint32_t;
+constexpr NodeHandle NULL_NODE = UINT32_MAX;
+
+// Hot part of a resting order: what the matching loop touches, in half a cache line.
+// The price lives on the owning PriceLevel and a resting order is always a LIMIT, so
+// neither is stored here; the priority timestamp, owner-list links and a copy of the
+// price for owner-list walks sit in the parallel cold array. The owner fills what would
+// otherwise be padding, so a fill can skip the cold array entirely for unowned orders.
+struct OrderNode {
+    OrderId id;
+    Quantity quantity;
+    NodeHandle prev;
+    NodeHandle next;
+    Side side;
+    OwnerId owner;
+
+    explicit OrderNode(const Order& o)
+        : id(o.id), quantity(o.quantity), prev(NULL_NODE), next(NULL_NODE), side(o.side), owner(o.owner) {}
+};
+static_assert(sizeof(OrderNode) == 32, "hot order node must stay at half a cache line");
+
+// Rarely touched per-order data, indexed by the same NodeHandle
+struct OrderColdData {
+    uint64_t timestamp;  // Time priority (snapshots and amends only)
+    Price price;         // As entered, kept current by amends (owner-list walks, which have no level)
+    NodeHandle ownerPrev;  // Per-owner list (owned orders only)
+    NodeHandle ownerNext;
+};
+
+// Intrusive FIFO queue of pooled nodes (one per price level)
+struct OrderQueue {
+    NodeHandle head = NULL_NODE;
+    NodeHandle tail = NULL_NODE;
+    size_t count = 0;
+
+    bool empty() const { return head == NULL_NODE; }
+};
+
+// Preallocated order-node pool with a free list.
+// Nodes are recycled on release, so steady-state add/cancel/fill never touches the heap
+// as long as the number of live orders stays within the reserved capacity.
+class OrderPool {
+public:
+    explicit OrderPool(size_t capacity) : freeHead_(NULL_NODE), live_(0) {
+        reserve(capacity);
+    }
+
+    void reserve(size_t capacity) {
+        nodes_.reserve(capacity);
+        cold_.reserve(capacity);
+    }
+
+    // Release every node at once (capacity is kept)
+    void clear() {
+        nodes_.clear();
+        cold_.clear();
+        freeHead_ = NULL_NODE;
+        live_ = 0;
+    }
+
+    NodeHandle allocate(const Order& order) {
+        ++live_;
+        if (freeHead_ != NULL_NODE) {
+            NodeHandle h = freeHead_;
+            freeHead_ = nodes_[h].next;
+            nodes_[h] = OrderNode(order);
+            cold_[h] = {order.timestamp, order.price, NULL_NODE, NULL_NODE};
+            return h;
+        }
+        // Only grows the vectors once the reserved capacity is exhausted
+        nodes_.emplace_back(order);
+        cold_.push_back({order.timestamp, order.price, NULL_NODE, NULL_NODE});
+        return static_cast<NodeHandle>(nodes_.size() - 1);
+    }
+
+    void release(NodeHandle h) {
+        --live_;
+        nodes_[h].next = freeHead_;
+        freeHead_ = h;
+    }
+
+    OrderNode& operator[](NodeHandle h) { return nodes_[h]; }
+    const OrderNode& operator[](NodeHandle h) const { return nodes_[h]; }
+    OrderColdData& cold(NodeHandle h) { return cold_[h]; }
+    const OrderColdData& cold(NodeHandle h) const { return cold_[h]; }
+
+    // O(1) append at the back of a level's FIFO
+    void pushBack(OrderQueue& queue, NodeHandle h) {
+        OrderNode& node = nodes_[h];
+        node.prev = queue.tail;
+        node.next = NULL_NODE;
+        if (queue.tail != NULL_NODE) {
+            nodes_[queue.tail].next = h;
+        } else {
+            queue.head = h;
+        }
+        queue.tail = h;
+        ++queue.count;
+    }
+
+    // O(1) unlink from anywhere in a level's FIFO
+    void unlink(OrderQueue& queue, NodeHandle h) {
+        OrderNode& node = nodes_[h];
+        if (node.prev != NULL_NODE) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            queue.head = node.next;
+        }
+        if (node.next != NULL_NODE) {
+            nodes_[node.next].prev = node.prev;
+        } else {
+            queue.tail = node.prev;
+        }
+        node.prev = NULL_NODE;
+        node.next = NULL_NODE;
+        --queue.count;
+    }
+
+    // Same O(1) append/unlink on an owner's list, threaded through the cold array
+    void pushBackOwner(OrderQueue& queue, NodeHandle h) {
+        OrderColdData& cold = cold_[h];
+        cold.ownerPrev = queue.tail;
+        cold.ownerNext = NULL_NODE;
+        if (queue.tail != NULL_NODE) {
+            cold_[queue.tail].ownerNext = h;
+        } else {
+            queue.head = h;
+        }
+        queue.tail = h;
+        ++queue.count;
+    }
+
+    void unlinkOwner(OrderQueue& queue, NodeHandle h) {
+        OrderColdData& cold = cold_[h];
+        if (cold.ownerPrev != NULL_NODE) {
+            cold_[cold.ownerPrev].ownerNext = cold.ownerNext;
+        } else {
+            queue.head = cold.ownerNext;
+        }
+        if (cold.ownerNext != NULL_NODE) {
+            cold_[cold.ownerNext].ownerPrev = cold.ownerPrev;
+        } else {
+            queue.tail = cold.ownerPrev;
+        }
+        cold.ownerPrev = NULL_NODE;
+        cold.ownerNext = NULL_NODE;
+        --queue.count;
+    }
+
+    size_t capacity() const { return nodes_.capacity(); }
+    size_t liveCount() const { return live_; }
+    size_t memoryBytes() const {
+        return nodes_.capacity() * sizeof(OrderNode) + cold_.capacity() * sizeof(OrderColdData);
+    }
+
+private:
+    std::vector<OrderNode> nodes_;
+    std::vector<OrderColdData> cold_;
+    NodeHandle freeHead_;
+    size_t live_;
+};
+
+// Per-owner lists of pooled nodes, for O(k) mass cancel. Unowned orders are never listed.
+// An owner's entry outlives its orders, so a participant that pulls and re-enters its
+// quotes all session does not churn the map; the last owner touched is cached because
+// consecutive events usually come from the same session.
+class OwnerLists {
+public:
+    void add(OrderPool& pool, NodeHandle h) {
+        OwnerId owner = pool[h].owner;
+        if (owner != NO_OWNER) {
+            pool.pushBackOwner(listFor(owner), h);
+        }
+    }
+
+    void remove(OrderPool& pool, NodeHandle h) {
+        OwnerId owner = pool[h].owner;
+        if (owner != NO_OWNER) {
+            pool.unlinkOwner(listFor(owner), h);
+        }
+    }
+
+    // nullptr if the owner has never had an order listed
+    OrderQueue* find(OwnerId owner) {
+        auto it = lists_.find(owner);
+        return it == lists_.end() ? nullptr : &it->second;
+    }
+
+    size_t count(OwnerId owner) const {
+        auto it = lists_.find(owner);
+        return it == lists_.end() ? 0 : it->second.count;
+    }
+
+    void clear() {
+        lists_.clear();
+        lastOwner_ = NO_OWNER;
+        lastList_ = nullptr;
+    }
+
+    size_t memoryBytes() const {
+        constexpr size_t MAP_NODE_OVERHEAD = 2 * sizeof(void*);
+        return lists_.bucket_count() * sizeof(void*) +
+               lists_.size() * (sizeof(std::pair<const OwnerId, OrderQueue>) + MAP_NODE_OVERHEAD);
+    }
+
+private:
+    OrderQueue& listFor(OwnerId owner) {
+        if (owner != lastOwner_) {
+            lastList_ = &lists_[owner];  // Map nodes never move, so the pointer stays valid
+            lastOwner_ = owner;
+        }
+        return *lastList_;
+    }
+
+    std::unordered_map<OwnerId, OrderQueue> lists_;
+    OwnerId lastOwner_ = NO_OWNER;
+    OrderQueue* lastList_ = nullptr;
+};
+
+} // namespace LOB
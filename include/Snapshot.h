@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Order.h"
+#include <cstdint>
+
+namespace LOB {
+
+// Flat binary snapshot of resting book state:
+//   SnapshotHeader, then bidOrders records (best level first, FIFO within a level),
+//   then askOrders records in the same order, then stopOrders pending stops in firing order.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t timestamp;      // Book priority clock
+    uint64_t tradeCount;
+    uint64_t bidOrders;
+    uint64_t askOrders;
+    int64_t ladderBase;      // Ladder window the book was using (ladderLevels == 0 if none)
+    int64_t ladderTick;
+    uint64_t ladderLevels;
+    uint64_t stopOrders;
+    int64_t lastTradePrice;  // Valid if hasLastTrade (stop triggers depend on it)
+    uint64_t hasLastTrade;
+    uint64_t inAuction;      // Saved mid-auction: the book may be crossed
+};
+static_assert(sizeof(SnapshotHeader) == 104, "SnapshotHeader must stay 104 bytes");
+
+struct SnapshotOrder {
+    uint64_t id;
+    int64_t price;
+    uint64_t quantity;
+    uint64_t timestamp;
+    uint32_t owner;
+    uint32_t reserved;
+};
+static_assert(sizeof(SnapshotOrder) == 40, "SnapshotOrder must stay 40 bytes");
+
+struct SnapshotStop {
+    uint64_t id;
+    int64_t stopPrice;
+    int64_t limitPrice;  // STOP_LIMIT only
+    uint64_t quantity;
+    uint64_t timestamp;
+    uint8_t side;
+    uint8_t type;        // OrderType::STOP or STOP_LIMIT
+    uint8_t reserved[2];
+    uint32_t owner;
+};
+static_assert(sizeof(SnapshotStop) == 48, "SnapshotStop must stay 48 bytes");
+constexpr char SNAPSHOT_MAGIC[8] = {'L', 'O', 'B', 'S', 'N', 'A', 'P', '1'};
+// 2: pending stops and last trade price; 3: order owners; 4: auction phase
+constexpr uint32_t SNAPSHOT_VERSION = 4;
+
+} // namespace LOB
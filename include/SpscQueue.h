@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LOB {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free single-producer/single-consumer ring.
+// Producer and consumer indices live on separate cache lines, and each side keeps
+// a private cached copy of the other's index so the shared line is only re-read
+// when the ring looks full (producer) or empty (consumer).
+template<typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : head_(0), cachedTail_(0), tail_(0), cachedHead_(0) {
+        size_t slots = 2;
+        while (slots < capacity) {
+            slots *= 2;
+        }
+        slots_.resize(slots);
+        mask_ = slots - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer: false if full
+    bool tryPush(const T& value) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - cachedTail_ > mask_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head - cachedTail_ > mask_) {
+                return false;
+            }
+        }
+        slots_[head & mask_] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: false if empty
+    bool tryPop(T& out) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) {
+                return false;
+            }
+        }
+        out = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: drain up to maxCount items with a single index publish
+    template<typename Fn>
+    size_t consumeBatch(size_t maxCount, Fn fn) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) {
+                return 0;
+            }
+        }
+        size_t available = static_cast<size_t>(cachedHead_ - tail);
+        size_t n = available < maxCount ? available : maxCount;
+        for (size_t i = 0; i < n; ++i) {
+            fn(slots_[(tail + i) & mask_]);
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    size_t size() const {
+        return static_cast<size_t>(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+    }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_;  // Written by producer
+    uint64_t cachedTail_;                                  // Producer-private
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_;  // Written by consumer
+    uint64_t cachedHead_;                                  // Consumer-private
+};
+
+} // namespace LOB
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "BookSide.h"
+#include "OrderIndex.h"
+#include "OrderPool.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace LOB {
+
+// Pending STOP / STOP_LIMIT orders, kept apart from the resting book. Each side is a map
+// of trigger price -> FIFO level ordered so that begin() is always the next stop to fire
+// (lowest buy trigger, highest sell trigger). Those two triggers are also cached inline,
+// so checking a trade against a million pending stops is two comparisons on values already
+// in cache, and pulling k fired stops costs O(k log N).
+// Nodes, id lookup and levels reuse the resting book's OrderPool / OrderIndex / PriceLevel.
+class StopBook {
+public:
+    explicit StopBook(size_t expectedStops = 0)
+        : pool_(expectedStops), index_(expectedStops), nextBuyTrigger_(NO_BUY), nextSellTrigger_(NO_SELL) {}
+
+    bool empty() const { return index_.empty(); }
+    size_t size() const { return index_.size(); }
+    bool contains(OrderId id) const { return index_.find(id) != nullptr; }
+
+    // order.type is STOP or STOP_LIMIT; the timestamp fixes FIFO order within a trigger price
+    void add(const Order& order) {
+        NodeHandle node = pool_.allocate(order);
+        if (node >= details_.size()) {
+            details_.resize(static_cast<size_t>(node) + 1);
+        }
+        details_[node] = Detail{order.price, order.type};
+        PriceLevel& level = order.side == Side::BUY ? levelFor(buyStops_, order.stopPrice)
+                                                    : levelFor(sellStops_, order.stopPrice);
+        pool_.pushBack(level.orders, node);
+        level.totalQuantity += order.quantity;
+        index_.insert(order.id, node, &level);
+        owners_.add(pool_, node);
+        if (order.side == Side::BUY) {
+            nextBuyTrigger_ = std::min(nextBuyTrigger_, order.stopPrice);
+        } else {
+            nextSellTrigger_ = std::max(nextSellTrigger_, order.stopPrice);
+        }
+    }
+
+    bool cancel(OrderId id) {
+        OrderIndex::Entry* entry = index_.find(id);
+        if (entry == nullptr) {
+            return false;
+        }
+        remove(entry);
+        return true;
+    }
+
+    // Cancels the owner's pending stops on the sides in sideMask (bit 0 buys, bit 1 sells)
+    // whose trigger lies in [low, high]; returns the number removed. O(owner's stops).
+    size_t cancelOwned(OwnerId owner, unsigned sideMask, Price low, Price high) {
+        OrderQueue* list = owners_.find(owner);
+        size_t removed = 0;
+        for (NodeHandle h = list ? list->head : NULL_NODE; h != NULL_NODE;) {
+            NodeHandle next = pool_.cold(h).ownerNext;
+            const OrderNode& stop = pool_[h];
+            if (sideMask & (stop.side == Side::BUY ? 1u : 2u)) {
+                OrderIndex::Entry* entry = index_.find(stop.id);
+                if (entry->level->price >= low && entry->level->price <= high) {
+                    remove(entry);
+                    ++removed;
+                }
+            }
+            h = next;
+        }
+        return removed;
+    }
+
+    size_t ownerCount(OwnerId owner) const { return owners_.count(owner); }
+
+    // Whether a trade at lastPrice fires anything
+    bool anyTriggered(Price lastPrice) const {
+        return lastPrice >= nextBuyTrigger_ || lastPrice <= nextSellTrigger_;
+    }
+
+    // Removes every stop fired by a trade at lastPrice and appends it to `out` as the
+    // order it becomes (STOP -> MARKET, STOP_LIMIT -> LIMIT). Firing order is fixed:
+    // buy stops by trigger then arrival, then sell stops the same way.
+    void collectTriggered(Price lastPrice, std::vector<Order>& out) {
+        drain(buyStops_, out, [&](Price trigger) { return trigger <= lastPrice; });
+        drain(sellStops_, out, [&](Price trigger) { return trigger >= lastPrice; });
+        refreshTriggers();
+    }
+
+    // Pending stops in firing order per side (buys first); fn(order) gets the original
+    // STOP / STOP_LIMIT order with its arrival timestamp
+    template<typename Fn>
+    void forEach(Fn fn) const {
+        visit(buyStops_, fn);
+        visit(sellStops_, fn);
+    }
+
+    void clear() {
+        buyStops_.clear();
+        sellStops_.clear();
+        pool_.clear();
+        index_.clear();
+        owners_.clear();
+        refreshTriggers();
+    }
+
+    size_t memoryBytes() const {
+        constexpr size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+        return pool_.memoryBytes() + index_.memoryBytes() + owners_.memoryBytes() +
+               details_.capacity() * sizeof(Detail) +
+               (buyStops_.size() + sellStops_.size()) * (sizeof(PriceLevel) + MAP_NODE_OVERHEAD);
+    }
+
+private:
+    static constexpr Price NO_BUY = std::numeric_limits<Price>::max();
+    static constexpr Price NO_SELL = std::numeric_limits<Price>::min();
+
+    struct Detail {
+        Price limitPrice;  // STOP_LIMIT only
+        OrderType type;
+    };
+
+    void remove(OrderIndex::Entry* entry) {
+        NodeHandle node = entry->node;
+        PriceLevel& level = *entry->level;
+        Side side = pool_[node].side;
+        level.totalQuantity -= pool_[node].quantity;
+        pool_.unlink(level.orders, node);
+        owners_.remove(pool_, node);
+        pool_.release(node);
+        index_.erase(entry);
+        if (level.orders.empty()) {
+            if (side == Side::BUY) {
+                buyStops_.erase(level.price);
+            } else {
+                sellStops_.erase(level.price);
+            }
+            refreshTriggers();
+        }
+    }
+
+    void refreshTriggers() {
+        nextBuyTrigger_ = buyStops_.empty() ? NO_BUY : buyStops_.begin()->first;
+        nextSellTrigger_ = sellStops_.empty() ? NO_SELL : sellStops_.begin()->first;
+    }
+
+    template<typename Map>
+    static PriceLevel& levelFor(Map& levels, Price trigger) {
+        return levels.try_emplace(trigger, trigger).first->second;
+    }
+
+    Order toOrder(NodeHandle node, Price trigger) const {
+        const OrderNode& stop = pool_[node];
+        const Detail& detail = details_[node];
+        return Order(stop.id, stop.side, detail.type, detail.limitPrice, stop.quantity,
+                     pool_.cold(node).timestamp, trigger, stop.owner);
+    }
+
+    template<typename Map, typename Fires>
+    void drain(Map& levels, std::vector<Order>& out, Fires fires) {
+        while (!levels.empty() && fires(levels.begin()->first)) {
+            PriceLevel& level = levels.begin()->second;
+            for (NodeHandle h = level.orders.head; h != NULL_NODE;) {
+                NodeHandle next = pool_[h].next;
+                Order fired = toOrder(h, level.price);
+                fired.type = fired.type == OrderType::STOP ? OrderType::MARKET : OrderType::LIMIT;
+                out.push_back(fired);
+                index_.erase(fired.id);
+                owners_.remove(pool_, h);
+                pool_.release(h);
+                h = next;
+            }
+            levels.erase(levels.begin());
+        }
+    }
+
+    template<typename Map, typename Fn>
+    void visit(const Map& levels, Fn& fn) const {
+        for (const auto& [trigger, level] : levels) {
+            for (NodeHandle h = level.orders.head; h != NULL_NODE; h = pool_[h].next) {
+                fn(toOrder(h, trigger));
+            }
+        }
+    }
+
+    OrderPool pool_;
+    OrderIndex index_;
+    OwnerLists owners_;
+    std::vector<Detail> details_;  // Parallel to pool_ nodes
+    std::map<Price, PriceLevel, std::less<Price>> buyStops_;      // Lowest trigger fires first
+    std::map<Price, PriceLevel, std::greater<Price>> sellStops_;  // Highest trigger fires first
+    Price nextBuyTrigger_;   // buyStops_ begin, or NO_BUY
+    Price nextSellTrigger_;  // sellStops_ begin, or NO_SELL
+};
+
+} // namespace LOB
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Order.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace LOB {
+
+// Best bid/ask and their level totals; a quantity of 0 means that side is empty
+struct TopOfBook {
+    Price bidPrice = 0;
+    Quantity bidQuantity = 0;
+    Price askPrice = 0;
+    Quantity askQuantity = 0;
+    uint64_t sequence = 0;  // Number of top-of-book changes published so far
+
+    bool hasBid() const { return bidQuantity > 0; }
+    bool hasAsk() const { return askQuantity > 0; }
+    bool sameQuote(const TopOfBook& other) const {
+        return bidPrice == other.bidPrice && bidQuantity == other.bidQuantity &&
+               askPrice == other.askPrice && askQuantity == other.askQuantity;
+    }
+};
+
+// Seqlock-protected top of book on its own cache line. One writer (the thread driving
+// the book) never waits; any number of readers copy the fields and retry if the version
+// moved or was odd (write in progress) while they read. Fields are relaxed atomics so
+// a torn read is detected rather than undefined.
+class alignas(CACHE_LINE_SIZE) SeqlockTopOfBook {
+public:
+    SeqlockTopOfBook()
+        : version_(0), bidPrice_(0), bidQuantity_(0), askPrice_(0), askQuantity_(0) {}
+
+    SeqlockTopOfBook(const SeqlockTopOfBook&) = delete;
+    SeqlockTopOfBook& operator=(const SeqlockTopOfBook&) = delete;
+
+    // Writer thread only; top.sequence is ignored (derived from the version)
+    void publish(const TopOfBook& top) {
+        uint64_t version = version_.load(std::memory_order_relaxed);
+        version_.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bidPrice_.store(top.bidPrice, std::memory_order_relaxed);
+        bidQuantity_.store(top.bidQuantity, std::memory_order_relaxed);
+        askPrice_.store(top.askPrice, std::memory_order_relaxed);
+        askQuantity_.store(top.askQuantity, std::memory_order_relaxed);
+        version_.store(version + 2, std::memory_order_release);
+    }
+
+    // Any thread: a consistent copy of the last completed publish
+    TopOfBook read() const {
+        TopOfBook top;
+        unsigned spins = 0;
+        while (true) {
+            uint64_t before = version_.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                top.bidPrice = bidPrice_.load(std::memory_order_relaxed);
+                top.bidQuantity = bidQuantity_.load(std::memory_order_relaxed);
+                top.askPrice = askPrice_.load(std::memory_order_relaxed);
+                top.askQuantity = askQuantity_.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (version_.load(std::memory_order_relaxed) == before) {
+                    top.sequence = before / 2;
+                    return top;
+                }
+            }
+            // The writer may have been descheduled mid-publish; stop burning its core
+            if (++spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    uint64_t sequence() const { return version_.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint64_t> version_;
+    std::atomic<Price> bidPrice_;
+    std::atomic<Quantity> bidQuantity_;
+    std::atomic<Price> askPrice_;
+    std::atomic<Quantity> askQuantity_;
+};
+
+static_assert(sizeof(SeqlockTopOfBook) == CACHE_LINE_SIZE, "top of book must fill exactly one cache line");
+
+} // namespace LOB
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Order.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace LOB {
+
+// Where executeTrade() sends fills
+enum class TradeSinkMode {
+    RECORD,    // Append to the in-memory history (getTrades()); unbounded, meant for tests/demos
+    CALLBACK,  // Invoke a user callback from inside the match loop
+    RING,      // Publish into a fixed-capacity TradeRing
+    NONE       // Only count trades
+};
+
+// What a full TradeRing does with a new fill
+enum class RingPolicy {
+    OVERWRITE,  // Drop the oldest unread trade
+    BLOCK       // Spin until the consumer frees a slot
+};
+
+// Plain function pointer + context: a direct call, no std::function indirection
+using TradeCallback = void (*)(void* context, const Trade& trade);
+
+// Adapts any type with `void onTrade(const Trade&)` to a TradeCallback.
+// The listener's onTrade is inlined into the thunk.
+template<typename Listener>
+TradeCallback makeTradeCallback() {
+    return [](void* context, const Trade& trade) {
+        static_cast<Listener*>(context)->onTrade(trade);
+    };
+}
+
+// Bounded single-producer/single-consumer trade ring.
+// The matching thread pushes; one consumer (same or another thread) pops.
+// The consumer claims a slot by advancing tail_ with a CAS after copying it, so in
+// OVERWRITE mode a slot recycled underneath a reader is detected and discarded. Slots
+// are relaxed atomic words, so that racing copy is a discarded value rather than
+// undefined behaviour (as in SeqlockTopOfBook).
+class TradeRing {
+public:
+    TradeRing(size_t capacity, RingPolicy policy)
+        : policy_(policy), head_(0), tail_(0), dropped_(0) {
+        size_t slots = 1;
+        while (slots < capacity) {
+            slots *= 2;
+        }
+        slots_ = std::make_unique<Slot[]>(slots);
+        mask_ = slots - 1;
+    }
+
+    TradeRing(const TradeRing&) = delete;
+    TradeRing& operator=(const TradeRing&) = delete;
+
+    // Producer side
+    void push(const Trade& trade) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        while (head - tail > mask_) {
+            if (policy_ == RingPolicy::OVERWRITE) {
+                // Retire the oldest slot ourselves; losing the race means the consumer took it
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+            } else {
+                std::this_thread::yield();
+                tail = tail_.load(std::memory_order_acquire);
+            }
+        }
+        uint64_t words[Slot::WORDS];
+        std::memcpy(words, &trade, sizeof(trade));
+        Slot& slot = slots_[head & mask_];
+        for (size_t i = 0; i < Slot::WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Consumer side: false if empty
+    bool pop(Trade& out) {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        while (tail != head_.load(std::memory_order_acquire)) {
+            const Slot& slot = slots_[tail & mask_];
+            uint64_t words[Slot::WORDS];
+            for (size_t i = 0; i < Slot::WORDS; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            // Success orders the copy before the producer may reuse the slot
+            if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel)) {
+                std::memcpy(&out, words, sizeof(out));
+                return true;
+            }
+            // tail was reloaded by the failed CAS (overwritten under us); retry
+        }
+        return false;
+    }
+
+    template<typename Fn>
+    size_t drain(Fn fn) {
+        size_t n = 0;
+        Trade trade(0, 0, 0, 0, 0);
+        while (pop(trade)) {
+            fn(trade);
+            ++n;
+        }
+        return n;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+    size_t memoryBytes() const { return capacity() * sizeof(Slot); }
+    size_t size() const {
+        return static_cast<size_t>(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+    }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        static constexpr size_t WORDS = sizeof(Trade) / sizeof(uint64_t);
+        std::atomic<uint64_t> words[WORDS];
+    };
+    static_assert(sizeof(Slot) == sizeof(Trade), "trade ring slot must stay the size of a Trade");
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    RingPolicy policy_;
+    alignas(64) std::atomic<uint64_t> head_;
+    alignas(64) std::atomic<uint64_t> tail_;
+    std::atomic<uint64_t> dropped_;
+};
+
+} // namespace LOB
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Order.h"
+#include "Journal.h"
+#include "MappedFile.h"
+#include "TradeSink.h"
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace LOB {
+
+// Columnar trade tape: one file per Trade field, so an analytics pass reads only the
+// columns it needs. Each file is a header followed by independently decodable segments
+// of up to segmentTrades values. Values are LEB128 varints; DELTA columns store the
+// zigzagged difference from the previous value in the segment (the first is taken
+// against 0), which keeps ids, timestamps and prices to one or two bytes a trade.
+enum class TapeColumn : uint8_t {
+    PRICE = 0,
+    QUANTITY = 1,
+    BUY_ID = 2,
+    SELL_ID = 3,
+    TIMESTAMP = 4
+};
+constexpr size_t TAPE_COLUMN_COUNT = 5;
+
+enum class TapeEncoding : uint8_t {
+    PLAIN = 0,  // Varint of the value
+    DELTA = 1   // Varint of zigzag(value - previous)
+};
+
+struct TapeColumnHeader {
+    char magic[8];
+    uint32_t version;
+    uint8_t column;    // TapeColumn
+    uint8_t encoding;  // TapeEncoding
+    uint16_t reserved;
+};
+static_assert(sizeof(TapeColumnHeader) == 16, "TapeColumnHeader must stay 16 bytes");
+
+// Precedes each segment's payload in every column file
+struct TapeSegmentHeader {
+    uint32_t trades;
+    uint32_t bytes;
+};
+static_assert(sizeof(TapeSegmentHeader) == 8, "TapeSegmentHeader must stay 8 bytes");
+
+constexpr char TAPE_MAGIC[8] = {'L', 'O', 'B', 'T', 'A', 'P', 'E', '1'};
+constexpr uint32_t TAPE_VERSION = 1;
+
+// basePath + ".price", ".quantity", ".buy", ".sell" or ".time"
+std::string tapeColumnPath(const std::string& basePath, TapeColumn column);
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Streaming writer. Not for the match loop: run the book with TradeSinkMode::RING and
+// drain() the ring from the thread that owns the tape, so encoding and I/O never delay
+// matching. Segments are written (and optionally fsynced) whole, one per column.
+class TradeTapeWriter {
+public:
+    TradeTapeWriter() = default;
+    ~TradeTapeWriter();
+
+    TradeTapeWriter(const TradeTapeWriter&) = delete;
+    TradeTapeWriter& operator=(const TradeTapeWriter&) = delete;
+
+    // Creates (truncates) the five column files; false on I/O failure
+    bool open(const std::string& basePath, size_t segmentTrades = 65536, FsyncPolicy fsync = FsyncPolicy::NEVER);
+    void close();
+    bool isOpen() const { return columns_[TAPE_COLUMN_COUNT - 1].file != nullptr; }  // Opened last
+
+    void append(const Trade& trade) {
+        encode(columns_[0], trade.price);
+        encode(columns_[1], static_cast<int64_t>(trade.quantity));
+        encode(columns_[2], static_cast<int64_t>(trade.buyOrderId));
+        encode(columns_[3], static_cast<int64_t>(trade.sellOrderId));
+        encode(columns_[4], static_cast<int64_t>(trade.timestamp));
+        if (++pending_ >= segmentTrades_) {
+            flush();
+        }
+    }
+
+    // Appends everything currently in the ring; returns the number of trades taken
+    size_t drain(TradeRing& ring) {
+        return ring.drain([this](const Trade& trade) { append(trade); });
+    }
+
+    // Writes the open segment to every column (and fsyncs if configured)
+    bool flush();
+
+    uint64_t tradeCount() const { return tradeCount_ + pending_; }
+    uint64_t bytesWritten() const { return bytesWritten_; }  // All column files, headers included
+
+private:
+    struct Column {
+        std::FILE* file = nullptr;
+        TapeEncoding encoding = TapeEncoding::PLAIN;
+        std::vector<uint8_t> buffer;
+        int64_t previous = 0;
+    };
+
+    static void encode(Column& column, int64_t value) {
+        if (column.encoding == TapeEncoding::DELTA) {
+            // Wrapping difference: ids and timestamps may sit anywhere in the int64 range
+            uint64_t delta = static_cast<uint64_t>(value) - static_cast<uint64_t>(column.previous);
+            appendVarint(column.buffer, zigzagEncode(static_cast<int64_t>(delta)));
+            column.previous = value;
+        } else {
+            appendVarint(column.buffer, static_cast<uint64_t>(value));
+        }
+    }
+
+    Column columns_[TAPE_COLUMN_COUNT];
+    size_t segmentTrades_ = 65536;
+    size_t pending_ = 0;
+    FsyncPolicy fsync_ = FsyncPolicy::NEVER;
+    uint64_t tradeCount_ = 0;
+    uint64_t bytesWritten_ = 0;
+};
+
+// Read-only view of one column file, memory-mapped where the platform allows. Opening
+// and decoding touch only this column's pages.
+class TapeColumnReader {
+public:
+    // Sequential decoder over the column's values in trade order
+    class Cursor {
+    public:
+        bool next(int64_t& value);
+
+    private:
+        friend class TapeColumnReader;
+        const uint8_t* pos_ = nullptr;
+        const uint8_t* end_ = nullptr;         // End of the complete segments
+        const uint8_t* segmentEnd_ = nullptr;
+        uint32_t remaining_ = 0;               // Values left in the current segment
+        int64_t previous_ = 0;
+        bool delta_ = false;
+    };
+
+    TapeColumnReader() = default;
+
+    TapeColumnReader(const TapeColumnReader&) = delete;
+    TapeColumnReader& operator=(const TapeColumnReader&) = delete;
+
+    // False if the file is missing or not this column of a tape
+    bool open(const std::string& basePath, TapeColumn column);
+    void close();
+
+    uint64_t size() const { return count_; }  // Values in complete segments
+    size_t fileBytes() const { return file_.size(); }
+    Cursor cursor() const;
+
+    template<typename Fn>
+    void forEach(Fn fn) const {
+        Cursor values = cursor();
+        int64_t value;
+        while (values.next(value)) {
+            fn(value);
+        }
+    }
+
+private:
+    MappedFile file_;
+    const uint8_t* end_ = nullptr;
+    TapeEncoding encoding_ = TapeEncoding::PLAIN;
+    uint64_t count_ = 0;
+};
+
+// All five columns, for consumers that want whole trades back
+class TradeTapeReader {
+public:
+    // False unless every column opens and they agree on the trade count
+    bool open(const std::string& basePath);
+    void close();
+
+    uint64_t size() const { return columns_[0].size(); }
+    const TapeColumnReader& column(TapeColumn column) const { return columns_[static_cast<size_t>(column)]; }
+
+    template<typename Fn>
+    void forEach(Fn fn) const {
+        TapeColumnReader::Cursor cursors[TAPE_COLUMN_COUNT];
+        for (size_t c = 0; c < TAPE_COLUMN_COUNT; ++c) {
+            cursors[c] = columns_[c].cursor();
+        }
+        int64_t v[TAPE_COLUMN_COUNT];
+        for (uint64_t i = 0; i < size(); ++i) {
+            for (size_t c = 0; c < TAPE_COLUMN_COUNT; ++c) {
+                cursors[c].next(v[c]);
+            }
+            fn(Trade(static_cast<OrderId>(v[2]), static_cast<OrderId>(v[3]), v[0], static_cast<Quantity>(v[1]),
+                     static_cast<uint64_t>(v[4])));
+        }
+    }
+
+private:
+    TapeColumnReader columns_[TAPE_COLUMN_COUNT];
+};
+
+struct TapeVwap {
+    uint64_t trades = 0;
+    uint64_t volume = 0;
+    double notional = 0;  // Sum of price x quantity
+
+    double vwap() const { return volume > 0 ? notional / static_cast<double>(volume) : 0.0; }
+};
+
+// Volume-weighted average price from the price and quantity columns alone;
+// nullopt if either column cannot be opened
+std::optional<TapeVwap> computeTapeVwap(const std::string& basePath);
+
+} // namespace LOB
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace LOB {
+
+// How an idle consumer thread waits for new work
+enum class WaitStrategy {
+    SPIN,   // Busy-poll; lowest latency, burns the core
+    YIELD,  // Busy-poll, yielding the CPU between polls
+    FUTEX   // Spin briefly, then sleep in the kernel until a producer notifies (Linux futex)
+};
+
+// Consumer-side idling plus producer-side wakeup for one consumer thread.
+// With FUTEX this is an eventcount: the consumer raises sleeping_ before its last check
+// for work, and a producer bumps the epoch and makes the wake syscall only when it sees
+// the flag. While the consumer spins, notify() is a fence and a read of a line nobody
+// writes.
+class IdleWaiter {
+public:
+    explicit IdleWaiter(WaitStrategy strategy) : strategy_(strategy), epoch_(0), sleeping_(false), idlePolls_(0) {}
+
+    // Consumer: a poll found nothing. hasWork() is re-checked before sleeping so a
+    // concurrent notify() cannot be lost.
+    template<typename Pred>
+    void idle(Pred hasWork) {
+        ++idlePolls_;
+        switch (strategy_) {
+            case WaitStrategy::SPIN:
+                break;
+            case WaitStrategy::YIELD:
+                std::this_thread::yield();
+                break;
+            case WaitStrategy::FUTEX:
+                if (idlePolls_ < SPIN_BEFORE_SLEEP) {
+                    break;
+                }
+                {
+                    uint32_t epoch = epoch_.load(std::memory_order_acquire);
+                    sleeping_.store(true, std::memory_order_relaxed);
+                    // Pairs with the fence in notify(): either it sees the flag, or this
+                    // check sees its work
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (!hasWork()) {
+                        sleepWhile(epoch);
+                    }
+                    sleeping_.store(false, std::memory_order_relaxed);
+                }
+                break;
+        }
+    }
+
+    // Consumer: work was found
+    void reset() { idlePolls_ = 0; }
+
+    // Producer: new work has been published
+    void notify() {
+        if (strategy_ != WaitStrategy::FUTEX) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            // A bump the consumer has not read yet makes its futex wait return at once
+            epoch_.fetch_add(1, std::memory_order_release);
+            wake();
+        }
+    }
+
+    WaitStrategy strategy() const { return strategy_; }
+
+private:
+    static constexpr uint32_t SPIN_BEFORE_SLEEP = 1024;
+
+    // Blocks while epoch_ still equals `epoch` (or spuriously returns)
+    void sleepWhile(uint32_t epoch);
+    void wake();
+
+    WaitStrategy strategy_;
+    std::atomic<uint32_t> epoch_;
+    std::atomic<bool> sleeping_;
+    uint32_t idlePolls_;
+};
+
+} // namespace LOB
@@ -0,0 +1,153 @@
+#include "FlowGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LOB {
+
+namespace {
+
+// Cancels mostly hit orders placed a few events ago; the rest land anywhere in the book
+constexpr double RECENT_CANCEL_SHARE = 0.8;
+constexpr double RECENCY_P = 0.05;  // Mean ~19 orders back from the newest
+
+double logFailure(double p) {
+    p = std::min(std::max(p, 1e-6), 1.0 - 1e-6);
+    return std::log(1.0 - p);
+}
+
+} // namespace
+
+FlowGenerator::FlowGenerator(const FlowConfig& config)
+    : config_(config),
+      rng_(config.seed),
+      placementLog_(logFailure(config.touchConcentration)),
+      recencyLog_(logFailure(RECENCY_P)),
+      nextId_(1),
+      mid_(config.startPrice),
+      events_(0),
+      adds_(0),
+      cancels_(0),
+      burstRemaining_(0),
+      burstCancelNext_(false),
+      burstSide_(Side::BUY) {
+    config_.tickSize = std::max<Price>(1, config_.tickSize);
+    config_.lotSize = std::max<Quantity>(1, config_.lotSize);
+    config_.sweepLots = std::max<Quantity>(1, config_.sweepLots);
+    config_.maxLevelsOut = std::max<size_t>(1, config_.maxLevelsOut);
+    config_.maxResting = std::max<size_t>(1, config_.maxResting);
+    live_.reserve(config_.maxResting + 1);
+}
+
+size_t FlowGenerator::geometric(double logFailureProbability) {
+    // Inverse CDF; 1 - uniform() is in (0, 1]
+    return static_cast<size_t>(std::log(1.0 - uniform()) / logFailureProbability);
+}
+
+void FlowGenerator::stepMid(int direction) {
+    mid_ += direction * config_.tickSize;
+    if (mid_ < 2 * config_.tickSize) {
+        mid_ = 2 * config_.tickSize;
+    }
+    // Resting bids stay below the mid and asks above it, so a one-tick move can only land
+    // on quotes at exactly the new mid: pull them
+    for (size_t i = live_.size(); i-- > 0;) {
+        if (live_[i].price == mid_) {
+            stale_.push_back(live_[i]);
+            live_[i] = live_.back();  // Entries above i are already checked
+            live_.pop_back();
+        }
+    }
+}
+
+Order FlowGenerator::next() {
+    ++events_;
+
+    if (!stale_.empty()) {
+        LiveOrder order = stale_.back();
+        stale_.pop_back();
+        ++cancels_;
+        return Order(order.id, order.side, OrderType::CANCEL, 0, 0, 0);
+    }
+
+    // Quote flicker: the mid just moved, so one side pulls and re-posts at the touch
+    if (burstRemaining_ == 0 && uniform() < config_.burstProbability) {
+        burstRemaining_ = config_.burstLength;
+        burstSide_ = randomSide();
+        burstCancelNext_ = true;
+        stepMid(burstSide_ == Side::BUY ? 1 : -1);
+    }
+    if (burstRemaining_ > 0) {
+        if (burstCancelNext_ && !live_.empty()) {
+            burstCancelNext_ = false;
+            return makeCancel(true);
+        }
+        burstCancelNext_ = true;
+        --burstRemaining_;
+        return makeAdd(burstSide_, false);
+    }
+
+    if (uniform() < config_.midStepProbability) {
+        stepMid((rng_() & 1) ? 1 : -1);
+    }
+
+    double r = uniform();
+    if (r < config_.marketShare) {
+        Quantity lots = 1 + rng_() % config_.sweepLots;
+        ++adds_;
+        return Order(nextId_++, randomSide(), OrderType::MARKET, 0, lots * config_.lotSize, 0);
+    }
+    r -= config_.marketShare;
+    if (r < config_.modifyShare && !live_.empty()) {
+        return makeModify();
+    }
+    if (live_.size() >= config_.maxResting) {
+        return makeCancel(false);
+    }
+    // Cancel whenever the running cancel-to-add ratio is below target (stale pulls and
+    // burst cancels count too), so the ratio holds however often the mid moves
+    if (!live_.empty() && static_cast<double>(cancels_) < config_.cancelRatio * static_cast<double>(adds_)) {
+        return makeCancel(uniform() < RECENT_CANCEL_SHARE);
+    }
+    return makeAdd(randomSide(), uniform() < config_.aggressiveShare);
+}
+
+Order FlowGenerator::makeAdd(Side side, bool aggressive) {
+    Quantity quantity = 1 + rng_() % (2 * config_.lotSize - 1);
+    OrderId id = nextId_++;
+    ++adds_;
+    if (aggressive) {
+        // Marketable IOC at or one tick through the far touch; never rests, so not tracked
+        Price offset = static_cast<Price>(1 + rng_() % 2) * config_.tickSize;
+        return Order(id, side, OrderType::IOC, side == Side::BUY ? mid_ + offset : mid_ - offset, quantity, 0);
+    }
+    Price ticks = 1 + static_cast<Price>(std::min(geometric(placementLog_), config_.maxLevelsOut - 1));
+    Price price = side == Side::BUY ? mid_ - ticks * config_.tickSize : mid_ + ticks * config_.tickSize;
+    live_.push_back(LiveOrder{id, side, price});
+    return Order(id, side, OrderType::LIMIT, price, quantity, 0);
+}
+
+size_t FlowGenerator::pickLive(bool recentBias) {
+    if (recentBias) {
+        size_t back = std::min(geometric(recencyLog_), live_.size() - 1);
+        return live_.size() - 1 - back;
+    }
+    return static_cast<size_t>(rng_() % live_.size());
+}
+
+Order FlowGenerator::makeCancel(bool recentBias) {
+    size_t i = pickLive(recentBias);
+    LiveOrder victim = live_[i];
+    // Swap-remove: O(1), and only perturbs the age order of the moved newest entry
+    live_[i] = live_.back();
+    live_.pop_back();
+    ++cancels_;
+    return Order(victim.id, victim.side, OrderType::CANCEL, 0, 0, 0);
+}
+
+Order FlowGenerator::makeModify() {
+    const LiveOrder& target = live_[pickLive(true)];
+    Quantity quantity = 1 + rng_() % (2 * config_.lotSize - 1);
+    return Order(target.id, target.side, OrderType::MODIFY, target.price, quantity, 0);
+}
+
+} // namespace LOB
@@ -0,0 +1,102 @@
+#include "Journal.h"
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace LOB {
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+bool JournalWriter::open(const std::string& path, size_t batchRecords, FsyncPolicy fsync) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    batchRecords_ = batchRecords > 0 ? batchRecords : 1;
+    fsync_ = fsync;
+    recordCount_ = 0;
+    buffer_.clear();
+    buffer_.reserve(batchRecords_);
+
+    JournalHeader header;
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.recordSize = sizeof(JournalRecord);
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void JournalWriter::close() {
+    if (file_ == nullptr) {
+        return;
+    }
+    flush();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool JournalWriter::flush() {
+    if (file_ == nullptr) {
+        return false;
+    }
+    if (!buffer_.empty()) {
+        size_t written = std::fwrite(buffer_.data(), sizeof(JournalRecord), buffer_.size(), file_);
+        recordCount_ += written;
+        bool complete = written == buffer_.size();
+        buffer_.clear();
+        if (!complete) {
+            return false;
+        }
+    }
+    if (std::fflush(file_) != 0) {
+        return false;
+    }
+    if (fsync_ == FsyncPolicy::EVERY_BATCH) {
+#if defined(_WIN32)
+        return _commit(_fileno(file_)) == 0;
+#else
+        return ::fsync(fileno(file_)) == 0;
+#endif
+    }
+    return true;
+}
+
+JournalReader::~JournalReader() {
+    close();
+}
+
+bool JournalReader::open(const std::string& path) {
+    close();
+    if (!file_.open(path)) {
+        return false;
+    }
+    const JournalHeader* header = reinterpret_cast<const JournalHeader*>(file_.data());
+    if (file_.size() < sizeof(JournalHeader) ||
+        std::memcmp(header->magic, JOURNAL_MAGIC, sizeof(header->magic)) != 0 ||
+        header->recordSize != sizeof(JournalRecord)) {
+        file_.close();
+        return false;
+    }
+    records_ = reinterpret_cast<const JournalRecord*>(file_.data() + sizeof(JournalHeader));
+    // A torn trailing record from a crash is ignored
+    count_ = (file_.size() - sizeof(JournalHeader)) / sizeof(JournalRecord);
+    return true;
+}
+
+void JournalReader::close() {
+    file_.close();
+    records_ = nullptr;
+    count_ = 0;
+}
+
+} // namespace LOB
@@ -0,0 +1,147 @@
+#include "MarketDataFeed.h"
+#include <new>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LOB {
+
+MarketDataPublisher::~MarketDataPublisher() {
+    close();
+}
+
+bool MarketDataPublisher::create(const std::string& name, size_t capacity) {
+    close();
+#if defined(_WIN32)
+    (void)name;
+    (void)capacity;
+    return false;
+#else
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots *= 2;
+    }
+    size_t size = FEED_SLOTS_OFFSET + slots * sizeof(FeedSlot);
+    ::shm_unlink(name.c_str());  // Readers of a previous run keep their old mapping
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+    flags |= MAP_POPULATE;  // Fault the ring in now, not on the writer's first lap
+#endif
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    // ftruncate zero-fills: every stamp starts at 0, below any sequence's
+    char* base = static_cast<char*>(mapping);
+    header_ = new (base) FeedHeader;
+    slots_ = reinterpret_cast<FeedSlot*>(base + FEED_SLOTS_OFFSET);
+    mapSize_ = size;
+    mask_ = slots - 1;
+    sequence_ = 0;
+    name_ = name;
+    header_->version = FEED_VERSION;
+    header_->slotSize = sizeof(FeedSlot);
+    header_->capacity = slots;
+    header_->published.store(0, std::memory_order_relaxed);
+    // Magic last: a reader attaching mid-create sees a complete header or none
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, FEED_MAGIC, sizeof(header_->magic));
+    return true;
+#endif
+}
+
+void MarketDataPublisher::close() {
+#if !defined(_WIN32)
+    if (header_ != nullptr) {
+        ::munmap(header_, mapSize_);
+        ::shm_unlink(name_.c_str());
+    }
+#endif
+    header_ = nullptr;
+    slots_ = nullptr;
+    mapSize_ = 0;
+}
+
+MarketDataReader::~MarketDataReader() {
+    detach();
+}
+
+bool MarketDataReader::attach(const std::string& name) {
+    detach();
+#if defined(_WIN32)
+    (void)name;
+    return false;
+#else
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < FEED_SLOTS_OFFSET) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    const FeedHeader* header = static_cast<const FeedHeader*>(mapping);
+    uint64_t capacity = header->capacity;
+    if (std::memcmp(header->magic, FEED_MAGIC, sizeof(header->magic)) != 0 || header->version != FEED_VERSION ||
+        header->slotSize != sizeof(FeedSlot) || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        size < FEED_SLOTS_OFFSET + capacity * sizeof(FeedSlot)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+    header_ = header;
+    slots_ = reinterpret_cast<const FeedSlot*>(static_cast<const char*>(mapping) + FEED_SLOTS_OFFSET);
+    mapSize_ = size;
+    mask_ = capacity - 1;
+    cursor_ = published() + 1;
+    lost_ = 0;
+    return true;
+#endif
+}
+
+void MarketDataReader::detach() {
+#if !defined(_WIN32)
+    if (header_ != nullptr) {
+        ::munmap(const_cast<FeedHeader*>(header_), mapSize_);
+    }
+#endif
+    header_ = nullptr;
+    slots_ = nullptr;
+    mapSize_ = 0;
+}
+
+void MarketDataReader::rewind() {
+    // The writer may already be overwriting the slot after the last published one
+    uint64_t published = this->published();
+    uint64_t capacity = mask_ + 1;
+    cursor_ = published + 2 > capacity ? published + 2 - capacity : 1;
+}
+
+void MarketDataReader::resync() {
+    uint64_t from = cursor_;
+    rewind();
+    lost_ += cursor_ > from ? cursor_ - from : 0;
+}
+
+} // namespace LOB
@@ -0,0 +1,209 @@
+#include "MatchingEngine.h"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace LOB {
+
+MatchingEngine::MatchingEngine(const MatchingEngineConfig& config)
+    : config_(config), stopRequested_(false), running_(false) {
+    size_t shardCount = config_.shardCount;
+    if (shardCount == 0) {
+        shardCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    config_.shardCount = shardCount;
+    config_.batchSize = std::max<size_t>(1, config_.batchSize);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>(config_.queueCapacity));
+    }
+}
+
+MatchingEngine::~MatchingEngine() {
+    stop();
+}
+
+bool MatchingEngine::addSymbol(SymbolId symbol) {
+    size_t best = 0;
+    for (size_t i = 1; i < shards_.size(); ++i) {
+        if (shards_[i]->symbols.size() < shards_[best]->symbols.size()) {
+            best = i;
+        }
+    }
+    return assignSymbol(symbol, best);
+}
+
+bool MatchingEngine::assignSymbol(SymbolId symbol, size_t shard) {
+    if (running_ || shard >= shards_.size() || routes_.count(symbol) != 0) {
+        return false;
+    }
+    auto entry = std::make_unique<Symbol>();
+    entry->id = symbol;
+    entry->book = std::make_unique<OrderBook>(config_.bookConfig);
+    Shard& owner = *shards_[shard];
+    routes_[symbol] = {shard, static_cast<uint32_t>(owner.symbols.size()), entry->book.get()};
+    owner.symbols.push_back(std::move(entry));
+    return true;
+}
+
+void MatchingEngine::start() {
+    if (running_) {
+        return;
+    }
+    stopRequested_.store(false, std::memory_order_relaxed);
+    running_ = true;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->thread = std::thread(&MatchingEngine::runShard, this, i);
+#if defined(__linux__)
+        if (config_.pinThreads) {
+            unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % cores, &cpus);
+            pthread_setaffinity_np(shards_[i]->thread.native_handle(), sizeof(cpus), &cpus);
+        }
+#endif
+    }
+}
+
+void MatchingEngine::stop() {
+    if (!running_) {
+        return;
+    }
+    stopRequested_.store(true, std::memory_order_release);
+    for (auto& shard : shards_) {
+        shard->thread.join();
+    }
+    running_ = false;
+}
+
+bool MatchingEngine::submit(const EngineEvent& event) {
+    auto it = routes_.find(event.symbol);
+    if (it == routes_.end()) {
+        return false;
+    }
+    const Route& route = it->second;
+    ShardEvent shardEvent;
+    shardEvent.book = route.book;
+    shardEvent.symbolSlot = route.symbolSlot;
+    shardEvent.type = event.type;
+    shardEvent.order = event.order;
+    return shards_[route.shard]->queue.tryPush(shardEvent);
+}
+
+size_t MatchingEngine::cancelOnDisconnect(OwnerId owner) {
+    EngineEvent event;
+    event.type = EngineEventType::MASS_CANCEL;
+    event.order.owner = owner;
+    size_t queued = 0;
+    for (const auto& entry : routes_) {
+        event.symbol = entry.first;
+        queued += submit(event) ? 1 : 0;
+    }
+    return queued;
+}
+
+void MatchingEngine::apply(const ShardEvent& event) {
+    switch (event.type) {
+        case EngineEventType::ADD:
+            event.book->addOrder(event.order);
+            break;
+        case EngineEventType::CANCEL:
+            event.book->cancelOrder(event.order.id);
+            break;
+        case EngineEventType::MODIFY:
+            event.book->modifyOrder(event.order.id, event.order.price, event.order.quantity);
+            break;
+        case EngineEventType::MASS_CANCEL:
+            event.book->massCancel(event.order.owner);
+            break;
+        case EngineEventType::START_AUCTION:
+            event.book->startAuction();
+            break;
+        case EngineEventType::UNCROSS:
+            event.book->uncross();
+            break;
+    }
+}
+
+void MatchingEngine::runShard(size_t shardIndex) {
+    Shard& shard = *shards_[shardIndex];
+    unsigned idlePolls = 0;
+    while (true) {
+        size_t n = shard.queue.consumeBatch(config_.batchSize, [&](const ShardEvent& event) {
+            apply(event);
+            Symbol& symbol = *shard.symbols[event.symbolSlot];
+            symbol.events.store(symbol.events.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        });
+        if (n > 0) {
+            shard.events.store(shard.events.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            shard.batches.store(shard.batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            idlePolls = 0;
+            continue;
+        }
+        // Only exit once the queue is observed empty after the stop request
+        if (stopRequested_.load(std::memory_order_acquire)) {
+            if (shard.queue.empty()) {
+                break;
+            }
+            continue;
+        }
+        if (++idlePolls > 64) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t MatchingEngine::getShardOf(SymbolId symbol) const {
+    auto it = routes_.find(symbol);
+    return it == routes_.end() ? shards_.size() : it->second.shard;
+}
+
+OrderBook* MatchingEngine::getBook(SymbolId symbol) {
+    auto it = routes_.find(symbol);
+    return it == routes_.end() ? nullptr : it->second.book;
+}
+
+std::vector<ShardLoad> MatchingEngine::getShardLoads() const {
+    std::vector<ShardLoad> loads;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        const Shard& shard = *shards_[i];
+        loads.push_back({i, shard.symbols.size(),
+                         shard.events.load(std::memory_order_relaxed),
+                         shard.batches.load(std::memory_order_relaxed),
+                         shard.queue.size()});
+    }
+    return loads;
+}
+
+std::vector<SymbolLoad> MatchingEngine::getSymbolLoads() const {
+    std::vector<SymbolLoad> loads;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        for (const auto& symbol : shards_[i]->symbols) {
+            loads.push_back({symbol->id, i, symbol->events.load(std::memory_order_relaxed)});
+        }
+    }
+    return loads;
+}
+
+std::vector<std::pair<SymbolId, size_t>> MatchingEngine::planRebalance() const {
+    std::vector<SymbolLoad> loads = getSymbolLoads();
+    std::sort(loads.begin(), loads.end(), [](const SymbolLoad& a, const SymbolLoad& b) {
+        return a.events != b.events ? a.events > b.events : a.symbol < b.symbol;
+    });
+    // Heaviest symbol first onto the currently lightest shard
+    std::vector<uint64_t> shardTotals(shards_.size(), 0);
+    std::vector<std::pair<SymbolId, size_t>> plan;
+    plan.reserve(loads.size());
+    for (const SymbolLoad& load : loads) {
+        size_t target = static_cast<size_t>(
+            std::min_element(shardTotals.begin(), shardTotals.end()) - shardTotals.begin());
+        shardTotals[target] += std::max<uint64_t>(load.events, 1);
+        plan.emplace_back(load.symbol, target);
+    }
+    return plan;
+}
+
+} // namespace LOB
@@ -2,231 +2,1157 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <limits>
 
 namespace LOB {
 
-OrderBook::OrderBook() : timestamp_(0) {}
+OrderBook::OrderBook(const OrderBookConfig& config)
+    : ladderLevels_(config.ladderLevels),
+      ladderTickSize_(config.ladderTickSize > 0 ? config.ladderTickSize : 1),
+      ladderBasePrice_(config.ladderBasePrice),
+      pool_(config.orderPoolCapacity),
+      orderIndex_(config.orderPoolCapacity),
+      tradeSink_(config.tradeSink),
+      tradeCallback_(config.tradeCallback),
+      tradeCallbackContext_(config.tradeCallbackContext),
+      tradeCount_(0),
+      rejectedCount_(0),
+      depthCallback_(config.depthCallback),
+      depthCallbackContext_(config.depthCallbackContext),
+      trackDepth_(config.depthLevels > 0 || config.depthCallback != nullptr),
+      publishTop_(config.publishTopOfBook),
+      lastTradePrice_(0),
+      hasLastTrade_(false),
+      firingStops_(false),
+      auction_(false),
+      journal_(nullptr),
+      feed_(nullptr),
+      feedInstrument_(0),
+      hashState_(config.trackStateHash),
+      stateHash_(0),
+      stateHashInterval_(config.trackStateHash ? config.stateHashInterval : 0),
+      eventsSinceHash_(0),
+      changedSides_(0),
+      timestamp_(0) {
+    LOB_STATS(stats_ = std::make_unique<Stats>();)
+    if (tradeSink_ == TradeSinkMode::RING) {
+        tradeRing_ = std::make_unique<TradeRing>(config.tradeRingCapacity, config.tradeRingPolicy);
+    } else if (tradeSink_ == TradeSinkMode::CALLBACK && tradeCallback_ == nullptr) {
+        tradeSink_ = TradeSinkMode::NONE;
+    }
+    if (ladderLevels_ > 0 && ladderBasePrice_) {
+        anchorLadder(*ladderBasePrice_);
+    }
+    if (config.prefixVolumes) {
+        bids_.enablePrefixVolumes();
+        asks_.enablePrefixVolumes();
+    }
+    bidDepth_.init(config.depthLevels);
+    askDepth_.init(config.depthLevels);
+}
+
+bool OrderBook::addOrder(const Order& order) {
+    LOB_STATS(uint64_t start = readCycleCounter();)
+    if (journal_ != nullptr) {
+        journalEvent(JournalEventType::ADD, order.id, order.side, order.type, order.price, order.quantity,
+                     order.stopPrice, order.owner);
+    }
+    bool accepted = processOrder(order);
+    eventDone();
+    LOB_STATS(stats_->addOrderTicks.record(readCycleCounter() - start);)
+    return accepted;
+}
+
+bool OrderBook::cancelOrder(OrderId orderId) {
+    LOB_STATS(uint64_t start = readCycleCounter();)
+    if (journal_ != nullptr) {
+        journalEvent(JournalEventType::CANCEL, orderId, Side::BUY, OrderType::CANCEL, 0, 0);
+    }
+    bool found = processCancel(orderId);
+    eventDone();
+    LOB_STATS(stats_->cancelOrderTicks.record(readCycleCounter() - start);)
+    return found;
+}
+
+bool OrderBook::modifyOrder(OrderId orderId, Price newPrice, Quantity newQuantity) {
+    LOB_STATS(uint64_t start = readCycleCounter();)
+    if (journal_ != nullptr) {
+        journalEvent(JournalEventType::MODIFY, orderId, Side::BUY, OrderType::MODIFY, newPrice, newQuantity);
+    }
+    bool found = processModify(orderId, newPrice, newQuantity);
+    eventDone();
+    LOB_STATS(stats_->modifyOrderTicks.record(readCycleCounter() - start);)
+    return found;
+}
+
+size_t OrderBook::massCancel(OwnerId owner) {
+    return massCancel(owner, sideBit(Side::BUY) | sideBit(Side::SELL),
+                      std::numeric_limits<Price>::min(), std::numeric_limits<Price>::max());
+}
+
+size_t OrderBook::massCancel(OwnerId owner, Side side) {
+    return massCancel(owner, sideBit(side), std::numeric_limits<Price>::min(), std::numeric_limits<Price>::max());
+}
+
+size_t OrderBook::massCancel(OwnerId owner, Side side, Price low, Price high) {
+    return massCancel(owner, sideBit(side), low, high);
+}
+
+size_t OrderBook::massCancel(OwnerId owner, uint8_t sides, Price low, Price high) {
+    if (journal_ != nullptr) {
+        JournalRecord record{};
+        record.eventType = static_cast<uint8_t>(JournalEventType::MASS_CANCEL);
+        record.side = sides;
+        record.owner = owner;
+        setJournalPriceRange(record, low, high);
+        record.sequence = timestamp_;
+        journal_->append(record);
+    }
+    size_t removed = processMassCancel(owner, sides, low, high);
+    eventDone();
+    return removed;
+}
+
+QuoteReplaceResult OrderBook::replaceQuotes(OwnerId owner, const QuoteLevel* bids, size_t bidCount,
+                                             const QuoteLevel* asks, size_t askCount) {
+    QuoteReplaceResult result;
+    if (owner == NO_OWNER) {
+        return result;
+    }
+    // Current quotes: the owner's resting orders, by price then priority. No tree walk;
+    // each order's price is in its cold record alongside the owner-list links.
+    currentBidQuotes_.clear();
+    currentAskQuotes_.clear();
+    if (OrderQueue* list = owners_.find(owner)) {
+        for (NodeHandle h = list->head; h != NULL_NODE; h = pool_.cold(h).ownerNext) {
+            const OrderNode& node = pool_[h];
+            const OrderColdData& cold = pool_.cold(h);
+            CurrentQuote quote{cold.price, cold.timestamp, node.id, node.quantity};
+            (node.side == Side::BUY ? currentBidQuotes_ : currentAskQuotes_).push_back(quote);
+        }
+    }
+    auto byPriority = [](const CurrentQuote& a, const CurrentQuote& b) {
+        return a.price != b.price ? a.price < b.price : a.timestamp < b.timestamp;
+    };
+    std::sort(currentBidQuotes_.begin(), currentBidQuotes_.end(), byPriority);
+    std::sort(currentAskQuotes_.begin(), currentAskQuotes_.end(), byPriority);
+
+    // Wanted ladder: by price, empty levels dropped, first entry wins on a repeated price
+    auto prepare = [](std::vector<QuoteLevel>& wanted, const QuoteLevel* levels, size_t count) {
+        wanted.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (levels[i].quantity > 0) {
+                wanted.push_back(levels[i]);
+            }
+        }
+        std::stable_sort(wanted.begin(), wanted.end(),
+                         [](const QuoteLevel& a, const QuoteLevel& b) { return a.price < b.price; });
+        wanted.erase(std::unique(wanted.begin(), wanted.end(),
+                                 [](const QuoteLevel& a, const QuoteLevel& b) { return a.price == b.price; }),
+                     wanted.end());
+    };
+    prepare(wantedBidQuotes_, bids, bidCount);
+    prepare(wantedAskQuotes_, asks, askCount);
+
+    // Pulls before amends before adds, so a new quote never meets one being withdrawn
+    for (QuotePhase phase : {QuotePhase::CANCEL, QuotePhase::AMEND, QuotePhase::ADD}) {
+        applyQuoteDiff(owner, Side::BUY, phase, result);
+        applyQuoteDiff(owner, Side::SELL, phase, result);
+    }
+    eventDone();
+    return result;
+}
+
+void OrderBook::startAuction() {
+    if (journal_ != nullptr) {
+        journalEvent(JournalEventType::START_AUCTION, 0, Side::BUY, OrderType::LIMIT, 0, 0);
+    }
+    processStartAuction();
+    eventDone();
+}
+
+AuctionResult OrderBook::uncross() {
+    if (journal_ != nullptr) {
+        journalEvent(JournalEventType::UNCROSS, 0, Side::BUY, OrderType::LIMIT, 0, 0);
+    }
+    AuctionResult result = processUncross();
+    eventDone();
+    return result;
+}
+
+BatchResult OrderBook::processBatch(const Order* orders, size_t count) {
+    constexpr size_t PREFETCH_DISTANCE = 4;
+    constexpr size_t CANCEL_GROUP = 16;
+
+    uint64_t tradesBefore = tradeCount_;
+    changedSides_ = 0;
+    for (size_t i = 0; i < count && i < PREFETCH_DISTANCE; ++i) {
+        prefetchFor(orders[i]);
+    }
+
+    size_t i = 0;
+    while (i < count) {
+        if (orders[i].type == OrderType::CANCEL) {
+            // Touch every index slot of a cancel run before unlinking any of them
+            size_t end = i;
+            while (end < count && end - i < CANCEL_GROUP && orders[end].type == OrderType::CANCEL) {
+                orderIndex_.prefetch(orders[end].id);
+                ++end;
+            }
+            for (; i < end; ++i) {
+                addOrder(orders[i]);
+            }
+            // Restart the prefetch window after the run
+            for (size_t j = end; j < count && j < end + PREFETCH_DISTANCE; ++j) {
+                prefetchFor(orders[j]);
+            }
+            continue;
+        }
+        if (i + PREFETCH_DISTANCE < count) {
+            prefetchFor(orders[i + PREFETCH_DISTANCE]);
+        }
+        addOrder(orders[i]);
+        ++i;
+    }
+
+    BatchResult result;
+    result.events = count;
+    result.fills = tradeCount_ - tradesBefore;
+    result.bidsChanged = (changedSides_ & sideBit(Side::BUY)) != 0;
+    result.asksChanged = (changedSides_ & sideBit(Side::SELL)) != 0;
+    return result;
+}
+
+void OrderBook::prefetchFor(const Order& order) const {
+    switch (order.type) {
+        case OrderType::LIMIT:
+            if (order.side == Side::BUY) {
+                bids_.prefetch(order.price);
+            } else {
+                asks_.prefetch(order.price);
+            }
+            break;
+        case OrderType::CANCEL:
+        case OrderType::MODIFY:
+            orderIndex_.prefetch(order.id);
+            break;
+        case OrderType::MARKET:
+        case OrderType::IOC:
+        case OrderType::FOK:
+        case OrderType::STOP:
+        case OrderType::STOP_LIMIT:
+            break;
+    }
+}
+
+void OrderBook::journalEvent(JournalEventType type, OrderId id, Side side, OrderType orderType,
+                             Price price, Quantity quantity, Price stopPrice, OwnerId owner) {
+    JournalRecord record{};
+    record.eventType = static_cast<uint8_t>(type);
+    record.side = static_cast<uint8_t>(side);
+    record.orderType = static_cast<uint8_t>(orderType);
+    record.orderId = id;
+    record.price = price;
+    record.quantity = quantity;
+    setJournalStop(record, orderType, stopPrice);
+    record.sequence = timestamp_;
+    record.owner = owner;
+    journal_->append(record);
+}
+
+void OrderBook::journalStateHash() {
+    eventsSinceHash_ = 0;
+    JournalRecord record{};
+    record.eventType = static_cast<uint8_t>(JournalEventType::STATE_HASH);
+    record.orderId = stateHash_;
+    record.sequence = timestamp_;
+    journal_->append(record);
+}
+
+uint64_t OrderBook::computeStateHash() const {
+    uint64_t hash = 0;
+    auto addSide = [&](const auto& side) {
+        side.forEachLevel([&](const PriceLevel& level) {
+            for (NodeHandle h = level.orders.head; h != NULL_NODE; h = pool_[h].next) {
+                const OrderNode& order = pool_[h];
+                hash += orderStateHash(order.id, order.side, level.price, order.quantity, pool_.cold(h).timestamp);
+            }
+            return true;
+        });
+    };
+    addSide(bids_);
+    addSide(asks_);
+    return hash;
+}
+
+size_t OrderBook::replay(const JournalRecord* records, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const JournalRecord& record = records[i];
+        if (record.sequence != timestamp_) {
+            return i;  // Journal does not continue from this book's state
+        }
+        switch (static_cast<JournalEventType>(record.eventType)) {
+            case JournalEventType::ADD: {
+                OrderType type = static_cast<OrderType>(record.orderType);
+                bool stop = type == OrderType::STOP || type == OrderType::STOP_LIMIT;
+                processOrder(Order(record.orderId, static_cast<Side>(record.side), type, record.price,
+                                   record.quantity, 0, stop ? journalStopPrice(record) : 0, record.owner));
+                break;
+            }
+            case JournalEventType::MASS_CANCEL:
+                processMassCancel(record.owner, record.side, record.price, journalRangeHigh(record));
+                break;
+            case JournalEventType::START_AUCTION:
+                processStartAuction();
+                break;
+            case JournalEventType::UNCROSS:
+                processUncross();
+                break;
+            case JournalEventType::STATE_HASH:
+                if (hashState_ && record.orderId != stateHash_) {
+                    return i;  // Diverged from the journaling book before this point
+                }
+                continue;  // Not an event
+            case JournalEventType::CANCEL:
+                processCancel(record.orderId);
+                break;
+            case JournalEventType::MODIFY:
+                processModify(record.orderId, record.price, record.quantity);
+                break;
+            default:
+                return i;
+        }
+        eventDone();
+    }
+    return count;
+}
 
-void OrderBook::addOrder(const Order& order) {
+bool OrderBook::processOrder(const Order& order) {
+    if (order.type != OrderType::CANCEL && order.type != OrderType::MODIFY && isLive(order.id)) {
+        // A second live order under one id would leave the index pointing at only one of them
+        ++rejectedCount_;
+        return false;
+    }
     Order newOrder = order;
     newOrder.timestamp = timestamp_++;
+    bool accepted = true;
     
     switch (order.type) {
         case OrderType::LIMIT:
-            matchLimitOrder(newOrder);
+            dispatchOrder<LimitPolicy>(newOrder);
             break;
         case OrderType::MARKET:
-            matchMarketOrder(newOrder);
+            dispatchOrder<MarketPolicy>(newOrder);
             break;
         case OrderType::CANCEL:
-            cancelOrder(order.id);
+            accepted = processCancel(order.id);
             break;
         case OrderType::MODIFY:
-            modifyOrder(order.id, order.price, order.quantity);
+            accepted = processModify(order.id, order.price, order.quantity);
+            break;
+        case OrderType::IOC:
+            dispatchOrder<IocPolicy>(newOrder);
+            break;
+        case OrderType::FOK:
+            dispatchOrder<FokPolicy>(newOrder);
+            break;
+        case OrderType::STOP:
+        case OrderType::STOP_LIMIT:
+            if (newOrder.quantity > 0) {
+                stops_.add(newOrder);  // May fire at once below if the last trade is already through it
+            }
             break;
     }
+    // Trigger check: the last trade against the nearest pending trigger on each side
+    if (hasLastTrade_ && !firingStops_ && !auction_ && stops_.anyTriggered(lastTradePrice_)) {
+        fireStops();
+    }
+    return accepted;
 }
 
-bool OrderBook::cancelOrder(OrderId orderId) {
-    auto it = orderIndex_.find(orderId);
-    if (it == orderIndex_.end()) {
-        return false;  // Order not found
+void OrderBook::fireStops() {
+    // Cascades run as a loop, not recursion: fired orders queue up in firing order, and any
+    // further stops their trades fire join the back of the queue
+    firingStops_ = true;
+    stops_.collectTriggered(lastTradePrice_, firedStops_);
+    for (size_t i = 0; i < firedStops_.size(); ++i) {
+        Order fired = firedStops_[i];  // Copied: processing may grow the queue
+        processOrder(fired);
+        if (stops_.anyTriggered(lastTradePrice_)) {
+            stops_.collectTriggered(lastTradePrice_, firedStops_);
+        }
     }
-    
-    removeFromBook(orderId);
-    return true;
+    firedStops_.clear();
+    firingStops_ = false;
 }
 
-bool OrderBook::modifyOrder(OrderId orderId, Price newPrice, Quantity newQuantity) {
-    auto it = orderIndex_.find(orderId);
-    if (it == orderIndex_.end()) {
-        return false;  // Order not found
+template<typename TypePolicy>
+void OrderBook::dispatchOrder(Order& order) {
+    if (order.side == Side::BUY) {
+        handleOrder<BuySide, TypePolicy>(order);
+    } else {
+        handleOrder<SellSide, TypePolicy>(order);
+    }
+}
+
+template<typename OrderSide, typename TypePolicy>
+void OrderBook::handleOrder(Order& order) {
+    if (auction_) {
+        // Call phase: limit orders rest as they are, crossing or not
+        if constexpr (TypePolicy::restsRemainder) {
+            if (order.quantity > 0) {
+                addToBook<OrderSide>(order);
+            }
+        }
+        return;
+    }
+    if constexpr (TypePolicy::allOrNothing) {
+        // Decided before any resting order is touched
+        if (!canFillCompletely<OrderSide>(order)) {
+            return;
+        }
     }
     
-    const OrderLocation& loc = it->second;
-    Order oldOrder = *loc.orderIt;
+    matchAgainstBook<OrderSide, TypePolicy>(order);
     
-    removeFromBook(orderId);
+    // Limit orders rest any remaining quantity; market/IOC/FOK remainders are cancelled
+    if constexpr (TypePolicy::restsRemainder) {
+        if (order.quantity > 0) {
+            addToBook<OrderSide>(order);
+        }
+    }
+}
 
-    Order newOrder = oldOrder;
-    newOrder.price = newPrice;
-    newOrder.quantity = newQuantity;
-    newOrder.timestamp = timestamp_++;  // New timestamp (loses priority)
+void OrderBook::reserve(size_t orderCount) {
+    pool_.reserve(orderCount);
+    orderIndex_.reserve(orderCount);
+}
+
+bool OrderBook::processCancel(OrderId orderId) {
+    OrderIndex::Entry* entry = orderIndex_.find(orderId);
+    if (entry == nullptr) {
+        return !stops_.empty() && stops_.cancel(orderId);  // Pending stop, or not found
+    }
     
-    addOrder(newOrder);
+    removeFromBook(entry);
     return true;
 }
 
-void OrderBook::matchLimitOrder(Order& order) {
-    if (order.side == Side::BUY) {
-        // Match against asks (sell orders)
-        matchAgainstBook(order, asks_, [](Price buyPrice, Price askPrice) {
-            return buyPrice >= askPrice;  // Buy can match if price >= ask
-        });
-    } else {
-        // Match against bids (buy orders)
-        matchAgainstBook(order, bids_, [](Price sellPrice, Price bidPrice) {
-            return sellPrice <= bidPrice;  // Sell can match if price <= bid
-        });
+bool OrderBook::processModify(OrderId orderId, Price newPrice, Quantity newQuantity) {
+    OrderIndex::Entry* entry = orderIndex_.find(orderId);
+    if (entry == nullptr) {
+        // Pending stops are cancel-only
+        return newQuantity == 0 && !stops_.empty() && stops_.cancel(orderId);
     }
     
-    // If there's remaining quantity, add to book
-    if (order.quantity > 0) {
-        addToBook(order);
+    if (newQuantity == 0) {
+        removeFromBook(entry);
+        return true;
     }
+    return pool_[entry->node].side == Side::BUY ? amendOrder<BuySide>(entry, newPrice, newQuantity)
+                                                      : amendOrder<SellSide>(entry, newPrice, newQuantity);
 }
 
-void OrderBook::matchMarketOrder(Order& order) {
-    if (order.side == Side::BUY) {
-        // Market buy: match against asks at any price
-        matchAgainstBook(order, asks_, [](Price, Price) {
-            return true;  // Always match
-        });
-    } else {
-        // Market sell: match against bids at any price
-        matchAgainstBook(order, bids_, [](Price, Price) {
-            return true;  // Always match
-        });
+void OrderBook::applyQuoteDiff(OwnerId owner, Side side, QuotePhase phase, QuoteReplaceResult& result) {
+    const std::vector<CurrentQuote>& current = side == Side::BUY ? currentBidQuotes_ : currentAskQuotes_;
+    const std::vector<QuoteLevel>& wanted = side == Side::BUY ? wantedBidQuotes_ : wantedAskQuotes_;
+    // Each constituent is journaled as the plain event it is, so replay needs nothing new
+    auto cancel = [&](const CurrentQuote& quote) {
+        if (journal_ != nullptr) {
+            journalEvent(JournalEventType::CANCEL, quote.id, Side::BUY, OrderType::CANCEL, 0, 0);
+        }
+        processCancel(quote.id);
+        ++result.cancelled;
+    };
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < current.size() || j < wanted.size()) {
+        if (j == wanted.size() || (i < current.size() && current[i].price < wanted[j].price)) {
+            if (phase == QuotePhase::CANCEL) {
+                cancel(current[i]);
+            }
+            ++i;
+        } else if (i == current.size() || wanted[j].price < current[i].price) {
+            if (phase == QuotePhase::ADD && isLive(wanted[j].id)) {
+                ++result.rejected;
+            } else if (phase == QuotePhase::ADD) {
+                const QuoteLevel& level = wanted[j];
+                if (journal_ != nullptr) {
+                    journalEvent(JournalEventType::ADD, level.id, side, OrderType::LIMIT, level.price,
+                                 level.quantity, 0, owner);
+                }
+                processOrder(Order(level.id, side, OrderType::LIMIT, level.price, level.quantity, 0, 0, owner));
+                ++result.added;
+            }
+            ++j;
+        } else {
+            // Quoted before and after: the oldest order at the price stays, any others go
+            const CurrentQuote& kept = current[i];
+            Price price = kept.price;
+            if (phase == QuotePhase::AMEND) {
+                if (kept.quantity == wanted[j].quantity) {
+                    ++result.unchanged;
+                } else {
+                    if (journal_ != nullptr) {
+                        journalEvent(JournalEventType::MODIFY, kept.id, Side::BUY, OrderType::MODIFY, price,
+                                     wanted[j].quantity);
+                    }
+                    processModify(kept.id, price, wanted[j].quantity);
+                    ++result.amended;
+                }
+            }
+            for (++i; i < current.size() && current[i].price == price; ++i) {
+                if (phase == QuotePhase::CANCEL) {
+                    cancel(current[i]);
+                }
+            }
+            ++j;
+        }
+    }
+}
+
+size_t OrderBook::processMassCancel(OwnerId owner, uint8_t sides, Price low, Price high) {
+    constexpr size_t PREFETCH_DISTANCE = 8;
+    size_t removed = stops_.empty() ? 0 : stops_.cancelOwned(owner, sides, low, high);
+    OrderQueue* list = owners_.find(owner);
+    if (list == nullptr || list->empty()) {
+        return removed;
+    }
+    // Distinct levels touched are bounded by both the owner's orders and each side's levels
+    auto sizeTable = [&](std::vector<LevelRemoval>& removals, size_t levels) {
+        size_t slots = 1;
+        while (slots < 2 * std::min(list->count, levels)) {
+            slots <<= 1;
+        }
+        removals.assign(slots, LevelRemoval{nullptr, 0});
+    };
+    sizeTable(bidRemovals_, bids_.levelCount());
+    sizeTable(askRemovals_, asks_.levelCount());
+
+    // Pass 1, per order: unlink from its level FIFO, the owner list and the index, and tally
+    // the quantity taken from its level. Index slots are random, so they are prefetched a
+    // few orders ahead along the owner list.
+    NodeHandle ahead = list->head;
+    for (size_t i = 0; i < PREFETCH_DISTANCE && ahead != NULL_NODE; ++i) {
+        orderIndex_.prefetch(pool_[ahead].id);
+        ahead = pool_.cold(ahead).ownerNext;
+    }
+    for (NodeHandle h = list->head; h != NULL_NODE;) {
+        if (ahead != NULL_NODE) {
+            orderIndex_.prefetch(pool_[ahead].id);
+            ahead = pool_.cold(ahead).ownerNext;
+        }
+        NodeHandle next = pool_.cold(h).ownerNext;
+        const OrderNode& node = pool_[h];
+        if (sides & sideBit(node.side)) {
+            OrderIndex::Entry* entry = orderIndex_.find(node.id);
+            PriceLevel* level = entry->level;
+            if (level->price >= low && level->price <= high) {
+                tallyRemoval(node.side == Side::BUY ? bidRemovals_ : askRemovals_, level, node.quantity);
+                hashOut(h, level->price);
+                feedEvent(FeedEventType::DELETE, node.side, node.id, level->price, node.quantity, timestamp_);
+                pool_.unlink(level->orders, h);
+                pool_.unlinkOwner(*list, h);
+                orderIndex_.erase(entry);
+                pool_.release(h);
+                ++removed;
+            }
+        }
+        h = next;
+    }
+    // Pass 2, per level: totals, prefix sums, empty-level removal and depth updates once each
+    settleRemovals<BuySide>(bidRemovals_);
+    settleRemovals<SellSide>(askRemovals_);
+    return removed;
+}
+
+void OrderBook::tallyRemoval(std::vector<LevelRemoval>& removals, PriceLevel* level, Quantity quantity) {
+    size_t mask = removals.size() - 1;
+    size_t i = static_cast<size_t>((reinterpret_cast<uintptr_t>(level) / sizeof(PriceLevel)) *
+                                   0x9E3779B97F4A7C15ull >> 32) & mask;
+    while (removals[i].level != nullptr && removals[i].level != level) {
+        i = (i + 1) & mask;
+    }
+    removals[i].level = level;
+    removals[i].quantity += quantity;
+}
+
+template<typename OrderSide>
+void OrderBook::settleRemovals(std::vector<LevelRemoval>& removals) {
+    auto& book = ownBook<OrderSide>();
+    bool any = false;
+    for (LevelRemoval& removal : removals) {
+        if (removal.level == nullptr) {
+            continue;
+        }
+        PriceLevel& level = *removal.level;
+        Price price = level.price;
+        book.removeQuantity(level, removal.quantity);
+        if (level.orders.empty()) {
+            book.erase(level);
+            levelChanged(OrderSide::side, price, 0, DepthAction::DELETE);
+        } else {
+            levelChanged(OrderSide::side, price, level.totalQuantity, DepthAction::CHANGE);
+        }
+        any = true;
+    }
+    if (any) {
+        changedSides_ |= sideBit(OrderSide::side);
     }
-    
-    // Market orders that can't be fully filled are cancelled (not added to book)
 }
 
-template<typename Comparator>
-void OrderBook::matchAgainstBook(Order& order, std::map<Price, PriceLevel, Comparator>& book,
-                                  bool (*canMatch)(Price, Price)) {
-    auto levelIt = book.begin();
+template<typename OrderSide>
+bool OrderBook::amendOrder(OrderIndex::Entry* entry, Price newPrice, Quantity newQuantity) {
+    auto& book = ownBook<OrderSide>();
+    NodeHandle node = entry->node;
+    OrderNode& order = pool_[node];
+    PriceLevel& level = *entry->level;
+    changedSides_ |= sideBit(OrderSide::side);
+    
+    if (newPrice == level.price) {
+        hashOut(node, level.price);
+        if (newQuantity > order.quantity) {
+            book.addQuantity(level, newQuantity - order.quantity);
+            // Size increase loses priority: requeue at the back of the same level
+            pool_.unlink(level.orders, node);
+            pool_.pushBack(level.orders, node);
+            pool_.cold(node).timestamp = timestamp_++;
+        } else {
+            book.removeQuantity(level, order.quantity - newQuantity);
+        }
+        // Size reduction keeps its place in the queue
+        order.quantity = newQuantity;
+        hashIn(node, level.price);
+        feedEvent(FeedEventType::MODIFY, OrderSide::side, order.id, newPrice, newQuantity, pool_.cold(node).timestamp);
+        levelChanged(OrderSide::side, newPrice, level.totalQuantity, DepthAction::CHANGE);
+        return true;
+    }
+    
+    if (!auction_ && wouldCross<OrderSide>(newPrice)) {
+        // Only a marketable amend goes through matching
+        Order amended(order.id, OrderSide::side, OrderType::LIMIT, newPrice, newQuantity, 0, 0, order.owner);
+        removeFromBook<OrderSide>(entry);
+        processOrder(amended);
+        return true;
+    }
     
-    while (levelIt != book.end() && order.quantity > 0) {
-        PriceLevel& level = levelIt->second;
+    // Passive price change: move the existing node to the back of the new level
+    Price oldPrice = level.price;
+    hashOut(node, oldPrice);
+    book.removeQuantity(level, order.quantity);
+    pool_.unlink(level.orders, node);
+    if (level.orders.empty()) {
+        book.erase(level);
+        levelChanged(OrderSide::side, oldPrice, 0, DepthAction::DELETE);
+    } else {
+        levelChanged(OrderSide::side, oldPrice, level.totalQuantity, DepthAction::CHANGE);
+    }
+    PriceLevel& target = book.findOrCreate(newPrice);
+    order.quantity = newQuantity;
+    pool_.cold(node).timestamp = timestamp_++;
+    pool_.cold(node).price = newPrice;
+    hashIn(node, newPrice);
+    pool_.pushBack(target.orders, node);
+    book.addQuantity(target, newQuantity);
+    entry->level = &target;
+    feedEvent(FeedEventType::MODIFY, OrderSide::side, order.id, newPrice, newQuantity, pool_.cold(node).timestamp);
+    levelChanged(OrderSide::side, newPrice, target.totalQuantity,
+                 target.orders.count == 1 ? DepthAction::NEW : DepthAction::CHANGE);
+    return true;
+}
+
+template<typename OrderSide>
+bool OrderBook::wouldCross(Price price) const {
+    const PriceLevel* best = oppositeBook<OrderSide>().best();
+    return best != nullptr && OrderSide::crosses(price, best->price);
+}
+
+template<typename OrderSide>
+bool OrderBook::canFillCompletely(const Order& order) const {
+    return oppositeBook<OrderSide>().volumeThrough(order.price, order.quantity) >= order.quantity;
+}
+
+template<typename OrderSide, typename TypePolicy>
+void OrderBook::matchAgainstBook(Order& order) {
+    auto& book = oppositeBook<OrderSide>();
+    LOB_STATS(uint64_t matchStart = readCycleCounter(); uint64_t levelsWalked = 0; uint64_t ordersFilled = 0;)
+    while (order.quantity > 0) {
+        PriceLevel* levelPtr = book.best();
+        if (levelPtr == nullptr) {
+            break;
+        }
+        PriceLevel& level = *levelPtr;
         
-        // Check if price can match
-        if (!canMatch(order.price, level.price)) {
-            break;  // No more matching possible
+        // Check if price can match (market orders take any price)
+        if constexpr (TypePolicy::priceLimited) {
+            if (!OrderSide::crosses(order.price, level.price)) {
+                break;  // No more matching possible
+            }
         }
+        LOB_STATS(++levelsWalked;)
         
-        auto orderIt = level.orders.begin();
-        while (orderIt != level.orders.end() && order.quantity > 0) {
-            Order& restingOrder = *orderIt;
+        NodeHandle nodeHandle = level.orders.head;
+        while (nodeHandle != NULL_NODE && order.quantity > 0) {
+            OrderNode& restingOrder = pool_[nodeHandle];
             Quantity matchQty = std::min(order.quantity, restingOrder.quantity);
             
-            executeTrade(order, restingOrder, matchQty);
+            executeTrade<OrderSide>(order, restingOrder.id, level.price, matchQty);
+            LOB_STATS(++ordersFilled;)
             
             order.quantity -= matchQty;
+            hashOut(nodeHandle, level.price);
             restingOrder.quantity -= matchQty;
-            level.totalQuantity -= matchQty;
+            book.removeQuantity(level, matchQty);
             
+            NodeHandle next = restingOrder.next;
             if (restingOrder.quantity == 0) {
-                // Remove fully filled order
+                // Remove fully filled order and recycle its node
                 orderIndex_.erase(restingOrder.id);
-                orderIt = level.orders.erase(orderIt);
+                pool_.unlink(level.orders, nodeHandle);
+                if (restingOrder.owner != NO_OWNER) {
+                    owners_.remove(pool_, nodeHandle);
+                }
+                pool_.release(nodeHandle);
             } else {
-                ++orderIt;
+                hashIn(nodeHandle, level.price);
             }
+            nodeHandle = next;
         }
         
         // Remove empty price level
+        Price levelPrice = level.price;
         if (level.orders.empty()) {
-            levelIt = book.erase(levelIt);
+            book.erase(level);
+            levelChanged(OrderSide::opposite, levelPrice, 0, DepthAction::DELETE);
         } else {
-            ++levelIt;
+            levelChanged(OrderSide::opposite, levelPrice, level.totalQuantity, DepthAction::CHANGE);
         }
     }
+    LOB_STATS(
+        if (levelsWalked > 0) {
+            stats_->matchTicks.record(readCycleCounter() - matchStart);
+            stats_->levelsWalked.record(levelsWalked);
+            stats_->ordersFilled.record(ordersFilled);
+        }
+    )
 }
 
-void OrderBook::executeTrade(Order& aggressor, Order& resting, Quantity quantity) {
-    Price tradePrice = resting.price;  // Resting order price has priority
-    
-    OrderId buyId = aggressor.side == Side::BUY ? aggressor.id : resting.id;
-    OrderId sellId = aggressor.side == Side::SELL ? aggressor.id : resting.id;
-    
-    trades_.emplace_back(buyId, sellId, tradePrice, quantity, timestamp_);
+template<typename OrderSide>
+void OrderBook::executeTrade(const Order& aggressor, OrderId restingId, Price tradePrice, Quantity quantity) {
+    // tradePrice is the resting level's price, which has priority
+    OrderId buyId = OrderSide::side == Side::BUY ? aggressor.id : restingId;
+    OrderId sellId = OrderSide::side == Side::SELL ? aggressor.id : restingId;
+    changedSides_ |= sideBit(OrderSide::opposite);
+    recordTrade(buyId, sellId, tradePrice, quantity);
+}
+
+void OrderBook::recordTrade(OrderId buyId, OrderId sellId, Price tradePrice, Quantity quantity) {
+    ++tradeCount_;
+    feedEvent(FeedEventType::TRADE, Side::BUY, buyId, tradePrice, quantity, timestamp_, sellId);
+    lastTradePrice_ = tradePrice;
+    hasLastTrade_ = true;
+    switch (tradeSink_) {
+        case TradeSinkMode::RECORD:
+            trades_.emplace_back(buyId, sellId, tradePrice, quantity, timestamp_);
+            break;
+        case TradeSinkMode::CALLBACK:
+            tradeCallback_(tradeCallbackContext_, Trade(buyId, sellId, tradePrice, quantity, timestamp_));
+            break;
+        case TradeSinkMode::RING:
+            tradeRing_->push(Trade(buyId, sellId, tradePrice, quantity, timestamp_));
+            break;
+        case TradeSinkMode::NONE:
+            break;
+    }
     
     // Optional: Print trade for debugging
     // std::cout << "TRADE: " << quantity << " @ " << tradePrice << std::endl;
 }
 
-void OrderBook::addToBook(Order order) {
-    if (order.side == Side::BUY) {
-        auto [levelIt, inserted] = bids_.try_emplace(order.price, order.price);
-        PriceLevel& level = levelIt->second;
-        
-        level.orders.push_back(order);
-        level.totalQuantity += order.quantity;
-        orderIndex_[order.id] = {std::prev(level.orders.end()), order.price, order.side};
-    } else {
-        auto [levelIt, inserted] = asks_.try_emplace(order.price, order.price);
-        PriceLevel& level = levelIt->second;
+AuctionResult OrderBook::computeUncross() const {
+    AuctionResult result;
+    const PriceLevel* bestBid = bids_.best();
+    const PriceLevel* bestAsk = asks_.best();
+    if (bestBid == nullptr || bestAsk == nullptr || bestBid->price < bestAsk->price) {
+        return result;
+    }
+    // Only the crossed band [best ask, best bid] can trade: bids at or above the best ask
+    // (collected best first) and asks at or below the best bid
+    std::vector<std::pair<Price, Quantity>> bidLevels;
+    std::vector<std::pair<Price, Quantity>> askLevels;
+    Quantity bidTotal = 0;
+    bids_.forEachLevel([&](const PriceLevel& level) {
+        if (level.price < bestAsk->price) {
+            return false;
+        }
+        bidLevels.emplace_back(level.price, level.totalQuantity);
+        bidTotal += level.totalQuantity;
+        return true;
+    });
+    asks_.forEachLevel([&](const PriceLevel& level) {
+        if (level.price > bestBid->price) {
+            return false;
+        }
+        askLevels.emplace_back(level.price, level.totalQuantity);
+        return true;
+    });
 
-        level.orders.push_back(order);
-        level.totalQuantity += order.quantity;
-        orderIndex_[order.id] = {std::prev(level.orders.end()), order.price, order.side};
+    // One ascending sweep over the merged level prices: asks at or below p accumulate as
+    // p rises, bids at or above p drop away. Executable volume only changes at a level
+    // price, so these are the only candidates.
+    struct Candidate {
+        Price price;
+        Quantity bids;  // Bid quantity at or above price
+        Quantity asks;  // Ask quantity at or below price
+        Quantity volume() const { return std::min(bids, asks); }
+        Quantity imbalance() const { return bids > asks ? bids - asks : asks - bids; }
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(bidLevels.size() + askLevels.size());
+    size_t b = bidLevels.size();  // Bids walked from the back: ascending
+    size_t a = 0;
+    Quantity asksAtOrBelow = 0;
+    Quantity bidsBelow = 0;
+    while (a < askLevels.size() || b > 0) {
+        Price price = a < askLevels.size() ? askLevels[a].first : bidLevels[b - 1].first;
+        if (b > 0 && bidLevels[b - 1].first < price) {
+            price = bidLevels[b - 1].first;
+        }
+        if (a < askLevels.size() && askLevels[a].first == price) {
+            asksAtOrBelow += askLevels[a++].second;
+        }
+        candidates.push_back(Candidate{price, bidTotal - bidsBelow, asksAtOrBelow});
+        if (b > 0 && bidLevels[b - 1].first == price) {
+            bidsBelow += bidLevels[--b].second;
+        }
+    }
+
+    // Maximum volume, then minimum imbalance
+    Quantity bestVolume = 0;
+    Quantity bestImbalance = 0;
+    for (const Candidate& c : candidates) {
+        if (c.volume() > bestVolume || (c.volume() == bestVolume && c.imbalance() < bestImbalance)) {
+            bestVolume = c.volume();
+            bestImbalance = c.imbalance();
+        }
+    }
+    // Then market pressure: a surplus on the same side at every tied price pushes the price
+    // towards it; otherwise the price nearest the reference (last trade, else the middle of
+    // the tied range) wins, the lower one on a tie
+    bool allBuySurplus = true;
+    bool allSellSurplus = true;
+    Price lowest = 0;
+    Price highest = 0;
+    bool any = false;
+    for (const Candidate& c : candidates) {
+        if (c.volume() != bestVolume || c.imbalance() != bestImbalance) {
+            continue;
+        }
+        allBuySurplus = allBuySurplus && c.bids > c.asks;
+        allSellSurplus = allSellSurplus && c.asks > c.bids;
+        lowest = any ? lowest : c.price;
+        highest = c.price;
+        any = true;
+    }
+    Price chosen;
+    if (allBuySurplus) {
+        chosen = highest;
+    } else if (allSellSurplus) {
+        chosen = lowest;
+    } else {
+        Price reference = hasLastTrade_ ? lastTradePrice_ : lowest + (highest - lowest) / 2;
+        chosen = highest;
+        Price bestDistance = std::numeric_limits<Price>::max();
+        for (const Candidate& c : candidates) {
+            Price distance = c.price > reference ? c.price - reference : reference - c.price;
+            if (c.volume() == bestVolume && c.imbalance() == bestImbalance && distance < bestDistance) {
+                bestDistance = distance;
+                chosen = c.price;
+            }
+        }
+    }
+    for (const Candidate& c : candidates) {
+        if (c.price == chosen) {
+            result.crossed = true;
+            result.price = chosen;
+            result.volume = c.volume();
+            result.imbalance = c.imbalance();
+            result.imbalanceSide = c.bids >= c.asks ? Side::BUY : Side::SELL;
+            break;
+        }
     }
+    return result;
 }
 
-void OrderBook::removeFromBook(OrderId orderId) {
-    auto indexIt = orderIndex_.find(orderId);
-    if (indexIt == orderIndex_.end()) {
-        return;
+AuctionResult OrderBook::processUncross() {
+    AuctionResult result = computeUncross();
+    auction_ = false;
+    if (result.crossed) {
+        uint64_t tradesBefore = tradeCount_;
+        executeUncross(result.price, result.volume);
+        result.trades = tradeCount_ - tradesBefore;
+    }
+    // Stops the auction print went through fire now, in continuous matching
+    if (hasLastTrade_ && !firingStops_ && stops_.anyTriggered(lastTradePrice_)) {
+        fireStops();
     }
+    return result;
+}
+
+void OrderBook::executeUncross(Price price, Quantity volume) {
+    // Pair bids and asks off in price-time priority until the equilibrium volume is done;
+    // every fill prints at the auction price. Level totals, prefix sums and depth are
+    // settled once per level as each one is finished with.
+    auto settle = [&](auto& book, Side side, PriceLevel& level, Quantity taken) {
+        Price levelPrice = level.price;
+        book.removeQuantity(level, taken);
+        if (level.orders.empty()) {
+            book.erase(level);
+            levelChanged(side, levelPrice, 0, DepthAction::DELETE);
+        } else {
+            levelChanged(side, levelPrice, level.totalQuantity, DepthAction::CHANGE);
+        }
+    };
+    auto removeFilled = [&](PriceLevel& level, NodeHandle node) {
+        const OrderNode& filled = pool_[node];
+        orderIndex_.erase(filled.id);
+        if (filled.owner != NO_OWNER) {
+            owners_.remove(pool_, node);
+        }
+        pool_.unlink(level.orders, node);
+        pool_.release(node);
+    };
 
-    const OrderLocation& loc = indexIt->second;
-    std::map<Price, PriceLevel, std::greater<Price>>* bidBook = &bids_;
-    std::map<Price, PriceLevel, std::less<Price>>* askBook = &asks_;
+    PriceLevel* bidLevel = bids_.best();
+    PriceLevel* askLevel = asks_.best();
+    NodeHandle bidNode = bidLevel->orders.head;
+    NodeHandle askNode = askLevel->orders.head;
+    Quantity bidTaken = 0;
+    Quantity askTaken = 0;
+    while (volume > 0) {
+        OrderNode& bid = pool_[bidNode];
+        OrderNode& ask = pool_[askNode];
+        Quantity quantity = std::min(volume, std::min(bid.quantity, ask.quantity));
+        recordTrade(bid.id, ask.id, price, quantity);
+        hashOut(bidNode, bidLevel->price);
+        hashOut(askNode, askLevel->price);
+        bid.quantity -= quantity;
+        ask.quantity -= quantity;
+        bidTaken += quantity;
+        askTaken += quantity;
+        volume -= quantity;
 
-    if (loc.side == Side::BUY) {
-        auto levelIt = bidBook->find(loc.priceLevel);
-        if (levelIt != bidBook->end()) {
-            PriceLevel& level = levelIt->second;
-            level.totalQuantity -= loc.orderIt->quantity;
-            level.orders.erase(loc.orderIt);
-            if (level.orders.empty()) {
-                bidBook->erase(levelIt);
+        if (bid.quantity > 0) {
+            hashIn(bidNode, bidLevel->price);
+        }
+        if (ask.quantity > 0) {
+            hashIn(askNode, askLevel->price);
+        }
+        if (bid.quantity == 0) {
+            NodeHandle next = bid.next;
+            removeFilled(*bidLevel, bidNode);
+            bidNode = next;
+            if (bidNode == NULL_NODE) {
+                settle(bids_, Side::BUY, *bidLevel, bidTaken);
+                bidTaken = 0;
+                bidLevel = volume > 0 ? bids_.best() : nullptr;
+                bidNode = bidLevel != nullptr ? bidLevel->orders.head : NULL_NODE;
             }
         }
-    } else {
-        auto levelIt = askBook->find(loc.priceLevel);
-        if (levelIt != askBook->end()) {
-            PriceLevel& level = levelIt->second;
-            level.totalQuantity -= loc.orderIt->quantity;
-            level.orders.erase(loc.orderIt);
-            if (level.orders.empty()) {
-                askBook->erase(levelIt);
+        if (ask.quantity == 0) {
+            NodeHandle next = ask.next;
+            removeFilled(*askLevel, askNode);
+            askNode = next;
+            if (askNode == NULL_NODE) {
+                settle(asks_, Side::SELL, *askLevel, askTaken);
+                askTaken = 0;
+                askLevel = volume > 0 ? asks_.best() : nullptr;
+                askNode = askLevel != nullptr ? askLevel->orders.head : NULL_NODE;
             }
         }
     }
+    // Partly taken last levels
+    if (bidLevel != nullptr && bidTaken > 0) {
+        settle(bids_, Side::BUY, *bidLevel, bidTaken);
+    }
+    if (askLevel != nullptr && askTaken > 0) {
+        settle(asks_, Side::SELL, *askLevel, askTaken);
+    }
+    changedSides_ |= sideBit(Side::BUY) | sideBit(Side::SELL);
+}
+
+void OrderBook::anchorLadder(Price price) {
+    // Centre the window on the given price (or start it there if configured explicitly)
+    Price base = ladderBasePrice_ ? *ladderBasePrice_
+                                  : price - static_cast<Price>(ladderLevels_ / 2) * ladderTickSize_;
+    bids_.initLadder(base, ladderTickSize_, ladderLevels_);
+    asks_.initLadder(base, ladderTickSize_, ladderLevels_);
+}
+
+template<typename OrderSide>
+void OrderBook::addToBook(const Order& order) {
+    if (ladderLevels_ > 0 && !bids_.ladderEnabled()) {
+        anchorLadder(order.price);
+    }
+
+    auto& book = ownBook<OrderSide>();
+    PriceLevel& level = book.findOrCreate(order.price);
+    
+    NodeHandle node = pool_.allocate(order);
+    hashIn(node, order.price);
+    pool_.pushBack(level.orders, node);
+    book.addQuantity(level, order.quantity);
+    orderIndex_.insert(order.id, node, &level);
+    owners_.add(pool_, node);
+    feedEvent(FeedEventType::ADD, OrderSide::side, order.id, order.price, order.quantity, order.timestamp);
+    changedSides_ |= sideBit(OrderSide::side);
+    levelChanged(OrderSide::side, order.price, level.totalQuantity,
+                 level.orders.count == 1 ? DepthAction::NEW : DepthAction::CHANGE);
+}
+
+void OrderBook::removeFromBook(OrderIndex::Entry* entry) {
+    if (pool_[entry->node].side == Side::BUY) {
+        removeFromBook<BuySide>(entry);
+    } else {
+        removeFromBook<SellSide>(entry);
+    }
+}
+
+template<typename OrderSide>
+void OrderBook::removeFromBook(OrderIndex::Entry* entry) {
+    // The index entry points straight at the level: no side-map lookup needed
+    NodeHandle node = entry->node;
+    PriceLevel& level = *entry->level;
+    Price price = level.price;
+
+    ownBook<OrderSide>().removeQuantity(level, pool_[node].quantity);
+    pool_.unlink(level.orders, node);
+    bool levelEmptied = level.orders.empty();
+    Quantity remaining = level.totalQuantity;
+    if (levelEmptied) {
+        ownBook<OrderSide>().erase(level);
+    }
+    hashOut(node, price);
+    feedEvent(FeedEventType::DELETE, OrderSide::side, pool_[node].id, price, pool_[node].quantity, timestamp_);
+    owners_.remove(pool_, node);
+    pool_.release(node);
 
-    orderIndex_.erase(indexIt);
+    orderIndex_.erase(entry);
+    changedSides_ |= sideBit(OrderSide::side);
+    levelChanged(OrderSide::side, price, levelEmptied ? 0 : remaining,
+                 levelEmptied ? DepthAction::DELETE : DepthAction::CHANGE);
+}
+
+void OrderBook::publishLevel(Side side, Price price, Quantity total, DepthAction action) {
+    if (side == Side::BUY) {
+        bidDepth_.apply(bids_, price, total);
+    } else {
+        askDepth_.apply(asks_, price, total);
+    }
+    if (depthCallback_ != nullptr) {
+        depthCallback_(depthCallbackContext_, DepthUpdate{price, total, side, action});
+    }
+}
+
+void OrderBook::rebuildDepth() {
+    bidDepth_.rebuild(bids_);
+    askDepth_.rebuild(asks_);
+}
+
+void OrderBook::publishTopOfBook() {
+    TopOfBook top;
+    if (const PriceLevel* bid = bids_.best()) {
+        top.bidPrice = bid->price;
+        top.bidQuantity = bid->totalQuantity;
+    }
+    if (const PriceLevel* ask = asks_.best()) {
+        top.askPrice = ask->price;
+        top.askQuantity = ask->totalQuantity;
+    }
+    // Most events land behind the touch: leave the readers' cache line alone
+    if (top.sameQuote(lastTop_)) {
+        return;
+    }
+    lastTop_ = top;
+    topOfBook_.publish(top);
 }
 
 std::optional<Price> OrderBook::getBestBid() const {
-    if (bids_.empty()) {
+    const PriceLevel* level = bids_.best();
+    if (level == nullptr) {
         return std::nullopt;
     }
-    return bids_.begin()->first;
+    return level->price;
 }
 
 std::optional<Price> OrderBook::getBestAsk() const {
-    if (asks_.empty()) {
+    const PriceLevel* level = asks_.best();
+    if (level == nullptr) {
         return std::nullopt;
     }
-    return asks_.begin()->first;
+    return level->price;
+}
+
+Quantity OrderBook::getCumulativeVolume(Side side, Price limitPrice) const {
+    return side == Side::BUY ? bids_.volumeThrough(limitPrice) : asks_.volumeThrough(limitPrice);
 }
 
 std::optional<Quantity> OrderBook::getVolumeAtPrice(Side side, Price price) const {
-    if (side == Side::BUY) {
-        auto it = bids_.find(price);
-        if (it == bids_.end()) {
-            return std::nullopt;
-        }
-        return it->second.totalQuantity;
-    } else {
-        auto it = asks_.find(price);
-        if (it == asks_.end()) {
-            return std::nullopt;
-        }
-        return it->second.totalQuantity;
+    const PriceLevel* level = side == Side::BUY ? bids_.find(price) : asks_.find(price);
+    if (level == nullptr) {
+        return std::nullopt;
     }
+    return level->totalQuantity;
+}
+
+size_t OrderBook::getDepth(Side side, DepthLevel* out, size_t maxLevels) const {
+    const DepthLevel* levels = side == Side::BUY ? bidDepth_.data() : askDepth_.data();
+    size_t count = std::min(maxLevels, side == Side::BUY ? bidDepth_.size() : askDepth_.size());
+    std::copy_n(levels, count, out);  // levels is null with depth tracking off
+    return count;
+}
+
+StatsSnapshot OrderBook::getStats() const {
+#if defined(LOB_ENABLE_STATS)
+    return collectStats(false);
+#else
+    return StatsSnapshot();
+#endif
+}
+
+StatsSnapshot OrderBook::resetStats() {
+#if defined(LOB_ENABLE_STATS)
+    return collectStats(true);
+#else
+    return StatsSnapshot();
+#endif
+}
+
+#if defined(LOB_ENABLE_STATS)
+StatsSnapshot OrderBook::collectStats(bool takeAndReset) const {
+    StatsSnapshot snapshot;
+    snapshot.enabled = true;
+    snapshot.ticksPerNs = ticksPerNanosecond();
+    snapshot.addOrderTicks = stats_->addOrderTicks.snapshot(takeAndReset);
+    snapshot.cancelOrderTicks = stats_->cancelOrderTicks.snapshot(takeAndReset);
+    snapshot.modifyOrderTicks = stats_->modifyOrderTicks.snapshot(takeAndReset);
+    snapshot.matchTicks = stats_->matchTicks.snapshot(takeAndReset);
+    snapshot.levelsWalked = stats_->levelsWalked.snapshot(takeAndReset);
+    snapshot.ordersFilled = stats_->ordersFilled.snapshot(takeAndReset);
+    return snapshot;
+}
+#endif
+
+MemoryUsage OrderBook::getMemoryUsage() const {
+    MemoryUsage usage;
+    usage.levelBytes = bids_.memoryBytes() + asks_.memoryBytes() +
+                       bidDepth_.memoryBytes() + askDepth_.memoryBytes();
+    usage.orderBytes = pool_.memoryBytes();
+    usage.indexBytes = orderIndex_.memoryBytes() + owners_.memoryBytes();
+    usage.stopBytes = stops_.memoryBytes();
+    usage.tradeBytes = trades_.capacity() * sizeof(Trade) + (tradeRing_ ? tradeRing_->memoryBytes() : 0);
+    return usage;
 }
 
 void OrderBook::printBook(int depth) const {
@@ -235,23 +1161,23 @@ void OrderBook::printBook(int depth) const {
               << std::setw(15) << "ASKS" << "\n";
     std::cout << "----------------------------------------------------\n";
     
-    auto bidIt = bids_.begin();
-    auto askIt = asks_.begin();
+    const PriceLevel* bidLevel = bids_.best();
+    const PriceLevel* askLevel = asks_.best();
     
     for (int i = 0; i < depth; ++i) {
         // Print bid side
-        if (bidIt != bids_.end()) {
-            std::cout << std::setw(10) << bidIt->second.totalQuantity 
-                      << std::setw(15) << bidIt->first;
-            ++bidIt;
+        if (bidLevel != nullptr) {
+            std::cout << std::setw(10) << bidLevel->totalQuantity 
+                      << std::setw(15) << bidLevel->price;
+            bidLevel = bids_.next(*bidLevel);
         } else {
             std::cout << std::setw(25) << " ";
         }
         
         // Print ask side
-        if (askIt != asks_.end()) {
-            std::cout << std::setw(15) << askIt->second.totalQuantity << "\n";
-            ++askIt;
+        if (askLevel != nullptr) {
+            std::cout << std::setw(15) << askLevel->totalQuantity << "\n";
+            askLevel = asks_.next(*askLevel);
         } else {
             std::cout << "\n";
         }
@@ -272,7 +1198,7 @@ void OrderBook::printBook(int depth) const {
     }
     std::cout << "\n";
     std::cout << "Total Orders: " << getOrderCount() << "\n";
-    std::cout << "Total Trades: " << trades_.size() << "\n\n";
+    std::cout << "Total Trades: " << tradeCount_ << "\n\n";
 }
 
 } // namespace LOB
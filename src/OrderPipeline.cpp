@@ -0,0 +1,135 @@
+#include "OrderPipeline.h"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace LOB {
+
+OrderPipeline::OrderPipeline(const PipelineConfig& config)
+    : config_(config),
+      egress_(config.egressCapacity),
+      waiter_(config.waitStrategy),
+      stopRequested_(false),
+      processed_(0),
+      egressStalls_(0),
+      running_(false) {
+    config_.producers = std::max<size_t>(1, config_.producers);
+    config_.batchSize = std::max<size_t>(1, config_.batchSize);
+    for (size_t i = 0; i < config_.producers; ++i) {
+        ingress_.push_back(std::make_unique<SpscQueue<PipelineEvent>>(config_.ingressCapacity));
+    }
+    OrderBookConfig bookConfig = config_.bookConfig;
+    bookConfig.tradeSink = TradeSinkMode::CALLBACK;
+    bookConfig.tradeCallback = &OrderPipeline::onTrade;
+    bookConfig.tradeCallbackContext = this;
+    book_ = std::make_unique<OrderBook>(bookConfig);
+}
+
+OrderPipeline::~OrderPipeline() {
+    stop();
+}
+
+void OrderPipeline::start() {
+    if (running_) {
+        return;
+    }
+    stopRequested_.store(false, std::memory_order_relaxed);
+    running_ = true;
+    thread_ = std::thread(&OrderPipeline::run, this);
+#if defined(__linux__)
+    if (config_.pinCore >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(static_cast<unsigned>(config_.pinCore), &cpus);
+        pthread_setaffinity_np(thread_.native_handle(), sizeof(cpus), &cpus);
+    }
+#endif
+}
+
+void OrderPipeline::stop() {
+    if (!running_) {
+        return;
+    }
+    stopRequested_.store(true, std::memory_order_release);
+    waiter_.notify();
+    thread_.join();
+    running_ = false;
+}
+
+void OrderPipeline::onTrade(void* context, const Trade& trade) {
+    PipelineResult result;
+    result.type = PipelineResultType::FILL;
+    result.trade = trade;
+    static_cast<OrderPipeline*>(context)->publish(result);
+}
+
+void OrderPipeline::publish(const PipelineResult& result) {
+    // Back-pressure: wait for the result consumer rather than dropping acks/fills
+    while (!egress_.tryPush(result)) {
+        egressStalls_.store(egressStalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (config_.waitStrategy != WaitStrategy::SPIN) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void OrderPipeline::process(const PipelineEvent& event) {
+    const Order& order = event.order;
+    bool accepted = true;
+    switch (order.type) {
+        case OrderType::LIMIT:
+        case OrderType::MARKET:
+        case OrderType::IOC:
+        case OrderType::FOK:
+        case OrderType::STOP:
+        case OrderType::STOP_LIMIT:
+            accepted = book_->addOrder(order);
+            break;
+        case OrderType::CANCEL:
+            accepted = book_->cancelOrder(order.id);
+            break;
+        case OrderType::MODIFY:
+            accepted = book_->modifyOrder(order.id, order.price, order.quantity);
+            break;
+    }
+    PipelineResult ack;
+    ack.orderId = order.id;
+    ack.accepted = accepted;
+    ack.tag = event.tag;
+    publish(ack);
+}
+
+bool OrderPipeline::hasInbound() const {
+    for (const auto& ring : ingress_) {
+        if (!ring->empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OrderPipeline::run() {
+    while (true) {
+        size_t drained = 0;
+        for (auto& ring : ingress_) {
+            drained += ring->consumeBatch(config_.batchSize, [&](const PipelineEvent& event) { process(event); });
+        }
+        if (drained > 0) {
+            processed_.store(processed_.load(std::memory_order_relaxed) + drained, std::memory_order_relaxed);
+            waiter_.reset();
+            continue;
+        }
+        if (stopRequested_.load(std::memory_order_acquire)) {
+            if (!hasInbound()) {
+                break;
+            }
+            continue;
+        }
+        waiter_.idle([&] { return hasInbound() || stopRequested_.load(std::memory_order_acquire); });
+    }
+}
+
+} // namespace LOB
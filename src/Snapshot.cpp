@@ -0,0 +1,178 @@
+#include "OrderBook.h"
+#include "Snapshot.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+
+namespace LOB {
+
+namespace {
+
+template<typename Compare>
+bool writeSide(std::FILE* file, const BookSide<Compare>& side, const OrderPool& pool) {
+    std::vector<SnapshotOrder> chunk;
+    chunk.reserve(4096);
+    bool ok = true;
+    side.forEachLevel([&](const PriceLevel& level) {
+        for (NodeHandle h = level.orders.head; h != NULL_NODE; h = pool[h].next) {
+            const OrderNode& node = pool[h];
+            chunk.push_back({node.id, level.price, node.quantity, pool.cold(h).timestamp, node.owner, 0});
+            if (chunk.size() == chunk.capacity()) {
+                ok = ok && std::fwrite(chunk.data(), sizeof(SnapshotOrder), chunk.size(), file) == chunk.size();
+                chunk.clear();
+            }
+        }
+        return ok;
+    });
+    if (ok && !chunk.empty()) {
+        ok = std::fwrite(chunk.data(), sizeof(SnapshotOrder), chunk.size(), file) == chunk.size();
+    }
+    return ok;
+}
+
+template<typename Compare>
+size_t countOrders(const BookSide<Compare>& side) {
+    size_t count = 0;
+    side.forEachLevel([&](const PriceLevel& level) {
+        count += level.orders.count;
+        return true;
+    });
+    return count;
+}
+
+bool writeStops(std::FILE* file, const StopBook& stops) {
+    std::vector<SnapshotStop> records;
+    records.reserve(stops.size());
+    stops.forEach([&](const Order& stop) {
+        SnapshotStop record{};
+        record.id = stop.id;
+        record.stopPrice = stop.stopPrice;
+        record.limitPrice = stop.price;
+        record.quantity = stop.quantity;
+        record.timestamp = stop.timestamp;
+        record.side = static_cast<uint8_t>(stop.side);
+        record.type = static_cast<uint8_t>(stop.type);
+        record.owner = stop.owner;
+        records.push_back(record);
+    });
+    return records.empty() ||
+           std::fwrite(records.data(), sizeof(SnapshotStop), records.size(), file) == records.size();
+}
+
+} // namespace
+
+bool OrderBook::saveSnapshot(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.recordSize = sizeof(SnapshotOrder);
+    header.timestamp = timestamp_;
+    header.tradeCount = tradeCount_;
+    header.bidOrders = countOrders(bids_);
+    header.askOrders = countOrders(asks_);
+    header.stopOrders = stops_.size();
+    header.lastTradePrice = lastTradePrice_;
+    header.hasLastTrade = hasLastTrade_ ? 1 : 0;
+    header.inAuction = auction_ ? 1 : 0;
+    if (bids_.ladderEnabled()) {
+        header.ladderBase = bids_.ladder().base();
+        header.ladderTick = bids_.ladder().tick();
+        header.ladderLevels = bids_.ladder().size();
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writeSide(file, bids_, pool_) &&
+              writeSide(file, asks_, pool_) &&
+              writeStops(file, stops_);
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+bool OrderBook::loadSnapshot(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    size_t total = static_cast<size_t>(header.bidOrders + header.askOrders);
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION || header.recordSize != sizeof(SnapshotOrder) ||
+        file.size() < sizeof(SnapshotHeader) + total * sizeof(SnapshotOrder) +
+                      header.stopOrders * sizeof(SnapshotStop)) {
+        return false;  // Current state is left untouched
+    }
+    // Records are used in place from the mapping
+    const SnapshotOrder* records = reinterpret_cast<const SnapshotOrder*>(file.data() + sizeof(SnapshotHeader));
+
+    // Reset, keeping the saved ladder window when this book uses the same geometry
+    bids_.clear();
+    asks_.clear();
+    if (ladderLevels_ > 0 && !ladderBasePrice_ && header.ladderLevels == ladderLevels_ &&
+        header.ladderTick == ladderTickSize_) {
+        bids_.initLadder(header.ladderBase, ladderTickSize_, ladderLevels_);
+        asks_.initLadder(header.ladderBase, ladderTickSize_, ladderLevels_);
+    } else if (ladderLevels_ > 0 && !bids_.ladderEnabled() && total > 0) {
+        anchorLadder(records[0].price);
+    }
+    pool_.clear();
+    pool_.reserve(total);
+    orderIndex_.clear();
+    orderIndex_.reserve(total);
+    owners_.clear();
+    trades_.clear();
+
+    // One linear pass: records are already in level and FIFO order, so no matching checks.
+    // Index slots are prefetched a few records ahead since their placement is random.
+    constexpr size_t PREFETCH_DISTANCE = 8;
+    const SnapshotOrder* end = records + total;
+    auto loadSide = [&](auto& side, Side sideTag, const SnapshotOrder* first, const SnapshotOrder* last) {
+        PriceLevel* level = nullptr;
+        for (const SnapshotOrder* rec = first; rec != last; ++rec) {
+            if (end - rec > static_cast<ptrdiff_t>(PREFETCH_DISTANCE)) {
+                orderIndex_.prefetch(rec[PREFETCH_DISTANCE].id);
+            }
+            if (level == nullptr || level->price != rec->price) {
+                level = &side.appendLevel(rec->price);
+            }
+            NodeHandle node = pool_.allocate(Order(rec->id, sideTag, OrderType::LIMIT, rec->price,
+                                                   rec->quantity, rec->timestamp, 0, rec->owner));
+            pool_.pushBack(level->orders, node);
+            side.addQuantity(*level, rec->quantity);
+            orderIndex_.insert(rec->id, node, level);
+            owners_.add(pool_, node);
+        }
+    };
+    const SnapshotOrder* bidBegin = records;
+    const SnapshotOrder* askBegin = bidBegin + header.bidOrders;
+    loadSide(bids_, Side::BUY, bidBegin, askBegin);
+    loadSide(asks_, Side::SELL, askBegin, askBegin + header.askOrders);
+
+    // Stops are re-added in firing order, which restores their FIFO within each trigger
+    stops_.clear();
+    SnapshotStop stop;
+    const char* stopRecords = file.data() + sizeof(SnapshotHeader) + total * sizeof(SnapshotOrder);
+    for (uint64_t i = 0; i < header.stopOrders; ++i) {
+        std::memcpy(&stop, stopRecords + i * sizeof(SnapshotStop), sizeof(stop));
+        stops_.add(Order(stop.id, static_cast<Side>(stop.side), static_cast<OrderType>(stop.type),
+                         stop.limitPrice, stop.quantity, stop.timestamp, stop.stopPrice, stop.owner));
+    }
+
+    timestamp_ = header.timestamp;
+    tradeCount_ = header.tradeCount;
+    lastTradePrice_ = header.lastTradePrice;
+    hasLastTrade_ = header.hasLastTrade != 0;
+    auction_ = header.inAuction != 0;
+    stateHash_ = hashState_ ? computeStateHash() : 0;
+    // The delta feed is not replayed: consumers resync from getDepth() after a restore
+    rebuildDepth();
+    eventDone();
+    return true;
+}
+
+} // namespace LOB
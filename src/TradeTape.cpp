@@ -0,0 +1,227 @@
+#include "TradeTape.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace LOB {
+
+namespace {
+
+const char* const COLUMN_SUFFIXES[TAPE_COLUMN_COUNT] = {".price", ".quantity", ".buy", ".sell", ".time"};
+
+// Quantities are independent from trade to trade; everything else drifts slowly
+TapeEncoding encodingFor(TapeColumn column) {
+    return column == TapeColumn::QUANTITY ? TapeEncoding::PLAIN : TapeEncoding::DELTA;
+}
+
+bool readVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; pos < end && shift < 64; shift += 7) {
+        uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::string tapeColumnPath(const std::string& basePath, TapeColumn column) {
+    return basePath + COLUMN_SUFFIXES[static_cast<size_t>(column)];
+}
+
+TradeTapeWriter::~TradeTapeWriter() {
+    close();
+}
+
+bool TradeTapeWriter::open(const std::string& basePath, size_t segmentTrades, FsyncPolicy fsync) {
+    close();
+    // A segment's payload length must fit its 32-bit header field even at 10 bytes a value
+    segmentTrades_ = std::min<size_t>(segmentTrades > 0 ? segmentTrades : 1, UINT32_MAX / 10);
+    fsync_ = fsync;
+    pending_ = 0;
+    tradeCount_ = 0;
+    bytesWritten_ = 0;
+    for (size_t c = 0; c < TAPE_COLUMN_COUNT; ++c) {
+        Column& column = columns_[c];
+        column.file = std::fopen(tapeColumnPath(basePath, static_cast<TapeColumn>(c)).c_str(), "wb");
+        column.encoding = encodingFor(static_cast<TapeColumn>(c));
+        column.buffer.clear();
+        column.buffer.reserve(segmentTrades_ * 2);
+        column.previous = 0;
+        TapeColumnHeader header{};
+        std::memcpy(header.magic, TAPE_MAGIC, sizeof(header.magic));
+        header.version = TAPE_VERSION;
+        header.column = static_cast<uint8_t>(c);
+        header.encoding = static_cast<uint8_t>(column.encoding);
+        if (column.file == nullptr || std::fwrite(&header, sizeof(header), 1, column.file) != 1) {
+            close();
+            return false;
+        }
+        bytesWritten_ += sizeof(header);
+    }
+    return true;
+}
+
+void TradeTapeWriter::close() {
+    if (isOpen()) {
+        flush();
+    }
+    for (Column& column : columns_) {
+        if (column.file != nullptr) {  // Includes a partial open() that failed
+            std::fclose(column.file);
+            column.file = nullptr;
+        }
+    }
+}
+
+bool TradeTapeWriter::flush() {
+    if (!isOpen()) {
+        return false;
+    }
+    bool ok = true;
+    if (pending_ > 0) {
+        for (Column& column : columns_) {
+            TapeSegmentHeader header{static_cast<uint32_t>(pending_), static_cast<uint32_t>(column.buffer.size())};
+            ok &= std::fwrite(&header, sizeof(header), 1, column.file) == 1 &&
+                  std::fwrite(column.buffer.data(), 1, column.buffer.size(), column.file) == column.buffer.size();
+            bytesWritten_ += sizeof(header) + column.buffer.size();
+            column.buffer.clear();
+            column.previous = 0;  // Segments decode independently
+        }
+        tradeCount_ += pending_;
+        pending_ = 0;
+    }
+    for (Column& column : columns_) {
+        ok &= std::fflush(column.file) == 0;
+        if (fsync_ == FsyncPolicy::EVERY_BATCH) {
+#if defined(_WIN32)
+            ok &= _commit(_fileno(column.file)) == 0;
+#else
+            ok &= ::fsync(fileno(column.file)) == 0;
+#endif
+        }
+    }
+    return ok;
+}
+
+bool TapeColumnReader::Cursor::next(int64_t& value) {
+    while (remaining_ == 0) {
+        pos_ = segmentEnd_;
+        if (static_cast<size_t>(end_ - pos_) < sizeof(TapeSegmentHeader)) {
+            return false;
+        }
+        TapeSegmentHeader header;
+        std::memcpy(&header, pos_, sizeof(header));
+        pos_ += sizeof(header);
+        segmentEnd_ = pos_ + header.bytes;
+        remaining_ = header.trades;
+        previous_ = 0;
+    }
+    uint64_t raw;
+    if (!readVarint(pos_, segmentEnd_, raw)) {
+        remaining_ = 0;
+        end_ = segmentEnd_ = pos_;  // Corrupt segment: stop here, on this and every later call
+        return false;
+    }
+    --remaining_;
+    // Wrapping, like the encoder: the bytes are untrusted and deltas may span the int64 range
+    value = delta_ ? static_cast<int64_t>(static_cast<uint64_t>(previous_) + static_cast<uint64_t>(zigzagDecode(raw)))
+                   : static_cast<int64_t>(raw);
+    previous_ = value;
+    return true;
+}
+
+bool TapeColumnReader::open(const std::string& basePath, TapeColumn column) {
+    close();
+    if (!file_.open(tapeColumnPath(basePath, column))) {
+        return false;
+    }
+    TapeColumnHeader header;
+    if (file_.size() < sizeof(header)) {
+        file_.close();
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, TAPE_MAGIC, sizeof(header.magic)) != 0 || header.version != TAPE_VERSION ||
+        header.column != static_cast<uint8_t>(column) || header.encoding > static_cast<uint8_t>(TapeEncoding::DELTA)) {
+        file_.close();
+        return false;
+    }
+    encoding_ = static_cast<TapeEncoding>(header.encoding);
+    // Hop the segment headers to count values; a torn trailing segment from a crash is ignored
+    const uint8_t* pos = reinterpret_cast<const uint8_t*>(file_.data()) + sizeof(header);
+    const uint8_t* fileEnd = reinterpret_cast<const uint8_t*>(file_.data()) + file_.size();
+    while (static_cast<size_t>(fileEnd - pos) >= sizeof(TapeSegmentHeader)) {
+        TapeSegmentHeader segment;
+        std::memcpy(&segment, pos, sizeof(segment));
+        if (static_cast<size_t>(fileEnd - pos) - sizeof(segment) < segment.bytes) {
+            break;
+        }
+        pos += sizeof(segment) + segment.bytes;
+        count_ += segment.trades;
+    }
+    end_ = pos;
+    return true;
+}
+
+void TapeColumnReader::close() {
+    file_.close();
+    end_ = nullptr;
+    count_ = 0;
+}
+
+TapeColumnReader::Cursor TapeColumnReader::cursor() const {
+    Cursor values;
+    if (end_ != nullptr) {
+        values.segmentEnd_ = reinterpret_cast<const uint8_t*>(file_.data()) + sizeof(TapeColumnHeader);
+        values.end_ = end_;
+        values.delta_ = encoding_ == TapeEncoding::DELTA;
+    }
+    return values;
+}
+
+bool TradeTapeReader::open(const std::string& basePath) {
+    close();
+    for (size_t c = 0; c < TAPE_COLUMN_COUNT; ++c) {
+        if (!columns_[c].open(basePath, static_cast<TapeColumn>(c)) || columns_[c].size() != columns_[0].size()) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TradeTapeReader::close() {
+    for (TapeColumnReader& column : columns_) {
+        column.close();
+    }
+}
+
+std::optional<TapeVwap> computeTapeVwap(const std::string& basePath) {
+    TapeColumnReader prices;
+    TapeColumnReader quantities;
+    if (!prices.open(basePath, TapeColumn::PRICE) || !quantities.open(basePath, TapeColumn::QUANTITY)) {
+        return std::nullopt;
+    }
+    TapeVwap result;
+    TapeColumnReader::Cursor price = prices.cursor();
+    TapeColumnReader::Cursor quantity = quantities.cursor();
+    int64_t p;
+    int64_t q;
+    while (price.next(p) && quantity.next(q)) {
+        ++result.trades;
+        result.volume += static_cast<uint64_t>(q);
+        result.notional += static_cast<double>(p) * static_cast<double>(q);
+    }
+    return result;
+}
+
+} // namespace LOB
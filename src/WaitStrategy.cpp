@@ -0,0 +1,28 @@
+#include "WaitStrategy.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace LOB {
+
+void IdleWaiter::sleepWhile(uint32_t epoch) {
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain uint32_t");
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+#else
+    while (epoch_.load(std::memory_order_acquire) == epoch) {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+void IdleWaiter::wake() {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+} // namespace LOB
@@ -0,0 +1,551 @@
+#include "OrderBook.h"
+#include "FlowGenerator.h"
+#include "Journal.h"
+#include "TradeTape.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace LOB;
+
+// Replay driver: streams order events into one OrderBook and reports throughput,
+// per-event latency percentiles and the final book.
+//
+// Usage: replay FILE [--ladder LEVELS] [--pool N] [--tape BASE]    (journal binary, or .csv)
+//        replay --synthetic N [--seed S] [--ladder LEVELS] [--pool N] [--tape BASE]
+//        replay --generate N --out FILE [--seed S]          (binary, or CSV if FILE ends in .csv)
+//
+// Binary input is the event journal format (JournalWriter / setJournal), so a recorded
+// session replays as-is; record sequences are ignored and every event goes through the
+// public OrderBook calls (addOrder, cancelOrder, modifyOrder, massCancel, startAuction,
+// uncross). CSV rows are
+// `type,side,order_id,price,quantity[,stop_price[,owner]]` with type one of LIMIT, MARKET, IOC,
+// FOK, STOP, STOP_LIMIT, CANCEL, MODIFY and side BUY or SELL; a header row is optional.
+//
+// --tape BASE streams every fill into a columnar trade tape (BASE.price, BASE.quantity, ...)
+// from a second thread draining the book's trade ring, then reports its size and VWAP.
+
+namespace {
+
+struct ReplayOptions {
+    std::string input;
+    std::string output;
+    uint64_t synthetic = 0;  // Events to generate in-process (replay) or to a file (--generate)
+    bool generateOnly = false;
+    uint64_t seed = 42;
+    size_t ladderLevels = 0;
+    size_t poolCapacity = 1 << 20;
+    std::string tape;  // Trade tape base path; empty = no tape
+};
+
+bool endsWith(const std::string& text, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+const char* typeName(OrderType type) {
+    switch (type) {
+        case OrderType::LIMIT: return "LIMIT";
+        case OrderType::MARKET: return "MARKET";
+        case OrderType::CANCEL: return "CANCEL";
+        case OrderType::MODIFY: return "MODIFY";
+        case OrderType::IOC: return "IOC";
+        case OrderType::FOK: return "FOK";
+        case OrderType::STOP: return "STOP";
+        case OrderType::STOP_LIMIT: return "STOP_LIMIT";
+    }
+    return "?";
+}
+
+bool parseType(const char* text, size_t length, OrderType& out) {
+    for (OrderType type : {OrderType::LIMIT, OrderType::MARKET, OrderType::CANCEL,
+                           OrderType::MODIFY, OrderType::IOC, OrderType::FOK, OrderType::STOP,
+                           OrderType::STOP_LIMIT}) {
+        const char* name = typeName(type);
+        if (std::strlen(name) == length && std::strncmp(text, name, length) == 0) {
+            out = type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Journaled book-level events that are not order-shaped
+enum class ReplayKind : uint8_t {
+    ORDER,
+    MASS_CANCEL,    // order.owner, order.price .. rangeHigh, on the sides in sideMask
+    START_AUCTION,
+    UNCROSS
+};
+
+struct ReplayEvent {
+    Order order{0, Side::BUY, OrderType::LIMIT, 0, 0, 0};
+    ReplayKind kind = ReplayKind::ORDER;
+    uint8_t sideMask = 0;  // Bit 0 bids, bit 1 asks
+    Price rangeHigh = 0;
+};
+
+JournalRecord toRecord(const Order& order) {
+    JournalRecord record{};
+    switch (order.type) {
+        case OrderType::CANCEL:
+            record.eventType = static_cast<uint8_t>(JournalEventType::CANCEL);
+            break;
+        case OrderType::MODIFY:
+            record.eventType = static_cast<uint8_t>(JournalEventType::MODIFY);
+            break;
+        default:
+            record.eventType = static_cast<uint8_t>(JournalEventType::ADD);
+            break;
+    }
+    record.side = static_cast<uint8_t>(order.side);
+    record.orderType = static_cast<uint8_t>(order.type);
+    record.orderId = order.id;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    setJournalStop(record, order.type, order.stopPrice);
+    record.owner = order.owner;
+    return record;
+}
+
+ReplayEvent fromRecord(const JournalRecord& record) {
+    ReplayEvent event;
+    OrderType type = static_cast<OrderType>(record.orderType);
+    switch (static_cast<JournalEventType>(record.eventType)) {
+        case JournalEventType::CANCEL:
+            type = OrderType::CANCEL;
+            break;
+        case JournalEventType::MODIFY:
+            type = OrderType::MODIFY;
+            break;
+        case JournalEventType::START_AUCTION:
+            event.kind = ReplayKind::START_AUCTION;
+            return event;
+        case JournalEventType::UNCROSS:
+            event.kind = ReplayKind::UNCROSS;
+            return event;
+        case JournalEventType::MASS_CANCEL:
+            event.kind = ReplayKind::MASS_CANCEL;
+            event.sideMask = record.side;
+            event.rangeHigh = journalRangeHigh(record);
+            event.order = Order(0, Side::BUY, OrderType::CANCEL, record.price, 0, 0, 0, record.owner);
+            return event;
+        case JournalEventType::ADD:
+        case JournalEventType::STATE_HASH:  // Skipped by JournalSource
+            break;
+    }
+    bool stop = type == OrderType::STOP || type == OrderType::STOP_LIMIT;
+    event.order = Order(record.orderId, static_cast<Side>(record.side), type, record.price, record.quantity, 0,
+                        stop ? journalStopPrice(record) : 0, record.owner);
+    return event;
+}
+
+// Event sources; parsing and generation happen outside the timed region
+class EventSource {
+public:
+    virtual ~EventSource() = default;
+    // False at end of input or on a malformed event (then error() is non-empty)
+    virtual bool next(ReplayEvent& out) = 0;
+    const std::string& error() const { return error_; }
+
+protected:
+    std::string error_;
+};
+
+class JournalSource : public EventSource {
+public:
+    bool open(const std::string& path) { return reader_.open(path); }
+    bool next(ReplayEvent& out) override {
+        if (position_ == reader_.size()) {
+            return false;
+        }
+        // State hashes are checkpoints, not events
+        while (static_cast<JournalEventType>(reader_[position_].eventType) == JournalEventType::STATE_HASH) {
+            if (++position_ == reader_.size()) {
+                return false;
+            }
+        }
+        out = fromRecord(reader_[position_++]);
+        return true;
+    }
+
+private:
+    JournalReader reader_;
+    size_t position_ = 0;
+};
+
+class CsvSource : public EventSource {
+public:
+    ~CsvSource() override {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "r");
+        return file_ != nullptr;
+    }
+    bool next(ReplayEvent& out) override {
+        char line[256];
+        while (std::fgets(line, sizeof(line), file_) != nullptr) {
+            ++lineNumber_;
+            if (line[0] == '\n' || line[0] == '\r' || line[0] == '#') {
+                continue;
+            }
+            if (parse(line, out.order)) {
+                return true;
+            }
+            if (lineNumber_ == 1) {
+                continue;  // Header row
+            }
+            error_ = "malformed CSV row at line " + std::to_string(lineNumber_);
+            return false;
+        }
+        return false;
+    }
+
+private:
+    static bool parse(const char* line, Order& out) {
+        const char* comma = std::strchr(line, ',');
+        OrderType type;
+        if (comma == nullptr || !parseType(line, static_cast<size_t>(comma - line), type)) {
+            return false;
+        }
+        const char* field = comma + 1;
+        Side side;
+        if (std::strncmp(field, "BUY,", 4) == 0) {
+            side = Side::BUY;
+            field += 4;
+        } else if (std::strncmp(field, "SELL,", 5) == 0) {
+            side = Side::SELL;
+            field += 5;
+        } else {
+            return false;
+        }
+        char* end;
+        OrderId id = std::strtoull(field, &end, 10);
+        if (*end != ',') {
+            return false;
+        }
+        Price price = std::strtoll(end + 1, &end, 10);
+        if (*end != ',') {
+            return false;
+        }
+        Quantity quantity = std::strtoull(end + 1, &end, 10);
+        Price stopPrice = 0;
+        OwnerId owner = NO_OWNER;
+        if (*end == ',') {
+            stopPrice = std::strtoll(end + 1, &end, 10);
+            if (*end == ',') {
+                owner = static_cast<OwnerId>(std::strtoul(end + 1, &end, 10));
+            }
+        }
+        if (*end != '\0' && *end != '\n' && *end != '\r') {
+            return false;
+        }
+        out = Order(id, side, type, price, quantity, 0, stopPrice, owner);
+        return true;
+    }
+
+    std::FILE* file_ = nullptr;
+    uint64_t lineNumber_ = 0;
+};
+
+class SyntheticSource : public EventSource {
+public:
+    SyntheticSource(const FlowConfig& config, uint64_t events) : generator_(config), remaining_(events) {}
+    bool next(ReplayEvent& out) override {
+        if (remaining_ == 0) {
+            return false;
+        }
+        --remaining_;
+        out.order = generator_.next();
+        return true;
+    }
+
+private:
+    FlowGenerator generator_;
+    uint64_t remaining_;
+};
+
+int generate(const ReplayOptions& options) {
+    FlowConfig config;
+    config.seed = options.seed;
+    FlowGenerator generator(config);
+    if (endsWith(options.output, ".csv")) {
+        std::FILE* file = std::fopen(options.output.c_str(), "w");
+        if (file == nullptr) {
+            std::cerr << "Cannot create " << options.output << "\n";
+            return 1;
+        }
+        std::fprintf(file, "type,side,order_id,price,quantity\n");
+        for (uint64_t i = 0; i < options.synthetic; ++i) {
+            Order order = generator.next();
+            std::fprintf(file, "%s,%s,%llu,%lld,%llu", typeName(order.type),
+                         order.side == Side::BUY ? "BUY" : "SELL",
+                         static_cast<unsigned long long>(order.id), static_cast<long long>(order.price),
+                         static_cast<unsigned long long>(order.quantity));
+            if (order.type == OrderType::STOP || order.type == OrderType::STOP_LIMIT || order.owner != NO_OWNER) {
+                std::fprintf(file, ",%lld", static_cast<long long>(order.stopPrice));
+            }
+            if (order.owner != NO_OWNER) {
+                std::fprintf(file, ",%u", static_cast<unsigned>(order.owner));
+            }
+            std::fputc('\n', file);
+        }
+        bool ok = std::fclose(file) == 0;
+        std::cerr << "Wrote " << options.synthetic << " events to " << options.output << "\n";
+        return ok ? 0 : 1;
+    }
+    JournalWriter writer;
+    if (!writer.open(options.output, 4096)) {
+        std::cerr << "Cannot create " << options.output << "\n";
+        return 1;
+    }
+    for (uint64_t i = 0; i < options.synthetic; ++i) {
+        writer.append(toRecord(generator.next()));
+    }
+    bool ok = writer.flush();
+    writer.close();
+    std::cerr << "Wrote " << options.synthetic << " events to " << options.output << "\n";
+    return ok ? 0 : 1;
+}
+
+struct ReplayCounters {
+    uint64_t events = 0;
+    uint64_t byType[8] = {};
+    uint64_t rejectedCancels = 0;
+    uint64_t rejectedModifies = 0;
+    uint64_t massCancels = 0;
+    uint64_t massCancelled = 0;  // Orders removed by them
+    uint64_t auctions = 0;
+    uint64_t ticks = 0;  // Inside OrderBook calls only
+};
+
+void printLatency(const HistogramSnapshot& histogram, double ticksPerNs) {
+    auto ns = [&](uint64_t ticks) { return static_cast<uint64_t>(static_cast<double>(ticks) / ticksPerNs); };
+    std::cout << "latency (ns)      p50 " << ns(histogram.percentile(0.50))
+              << "  p90 " << ns(histogram.percentile(0.90))
+              << "  p99 " << ns(histogram.percentile(0.99))
+              << "  p99.9 " << ns(histogram.percentile(0.999))
+              << "  max " << ns(histogram.max) << "\n";
+}
+
+int replay(const ReplayOptions& options) {
+    std::unique_ptr<EventSource> source;
+    std::string label;
+    if (options.synthetic > 0) {
+        FlowConfig config;
+        config.seed = options.seed;
+        source = std::make_unique<SyntheticSource>(config, options.synthetic);
+        label = "synthetic flow, seed " + std::to_string(options.seed);
+    } else if (endsWith(options.input, ".csv")) {
+        auto csv = std::make_unique<CsvSource>();
+        if (!csv->open(options.input)) {
+            std::cerr << "Cannot open " << options.input << "\n";
+            return 1;
+        }
+        source = std::move(csv);
+        label = options.input;
+    } else {
+        auto journal = std::make_unique<JournalSource>();
+        if (!journal->open(options.input)) {
+            std::cerr << "Cannot open " << options.input << " as an event journal\n";
+            return 1;
+        }
+        source = std::move(journal);
+        label = options.input;
+    }
+
+    OrderBookConfig config;
+    config.orderPoolCapacity = options.poolCapacity;
+    config.ladderLevels = options.ladderLevels;
+    config.tradeSink = TradeSinkMode::NONE;
+    TradeTapeWriter tape;
+    if (!options.tape.empty()) {
+        if (!tape.open(options.tape)) {
+            std::cerr << "Cannot create trade tape " << options.tape << "\n";
+            return 1;
+        }
+        config.tradeSink = TradeSinkMode::RING;
+        config.tradeRingCapacity = 1 << 16;
+        config.tradeRingPolicy = RingPolicy::BLOCK;
+    }
+    OrderBook book(config);
+    // The tape is encoded and written on its own thread; the book only pushes to the ring
+    std::atomic<bool> replayDone{false};
+    std::thread tapeThread;
+    if (tape.isOpen()) {
+        tapeThread = std::thread([&] {
+            TradeRing& ring = *book.getTradeRing();
+            while (!replayDone.load(std::memory_order_acquire)) {
+                if (tape.drain(ring) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            tape.drain(ring);
+            tape.close();
+        });
+    }
+
+    LogLinearHistogram latency;
+    ReplayCounters counters;
+    auto wallStart = std::chrono::steady_clock::now();
+    ReplayEvent event;
+    while (source->next(event)) {
+        const Order& order = event.order;
+        if (event.kind != ReplayKind::ORDER) {
+            uint64_t start = readCycleCounter();
+            if (event.kind == ReplayKind::MASS_CANCEL) {
+                for (Side side : {Side::BUY, Side::SELL}) {
+                    if (event.sideMask & (side == Side::BUY ? 1 : 2)) {
+                        counters.massCancelled += book.massCancel(order.owner, side, order.price, event.rangeHigh);
+                    }
+                }
+                ++counters.massCancels;
+            } else if (event.kind == ReplayKind::START_AUCTION) {
+                book.startAuction();
+                ++counters.auctions;
+            } else {
+                book.uncross();
+            }
+            uint64_t ticks = readCycleCounter() - start;
+            latency.record(ticks);
+            counters.ticks += ticks;
+            ++counters.events;
+            continue;
+        }
+        uint64_t start = readCycleCounter();
+        bool accepted = true;
+        switch (order.type) {
+            case OrderType::CANCEL:
+                accepted = book.cancelOrder(order.id);
+                break;
+            case OrderType::MODIFY:
+                accepted = book.modifyOrder(order.id, order.price, order.quantity);
+                break;
+            default:
+                book.addOrder(order);
+                break;
+        }
+        uint64_t ticks = readCycleCounter() - start;
+        latency.record(ticks);
+        counters.ticks += ticks;
+        ++counters.events;
+        ++counters.byType[static_cast<size_t>(order.type)];
+        if (!accepted) {
+            ++(order.type == OrderType::CANCEL ? counters.rejectedCancels : counters.rejectedModifies);
+        }
+    }
+    replayDone.store(true, std::memory_order_release);
+    if (tapeThread.joinable()) {
+        tapeThread.join();
+    }
+    if (!source->error().empty()) {
+        std::cerr << options.input << ": " << source->error() << "\n";
+        return 1;
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double ticksPerNs = ticksPerNanosecond();
+    double bookSeconds = static_cast<double>(counters.ticks) / ticksPerNs / 1e9;
+
+    auto rate = [&](double seconds) { return seconds > 0 ? static_cast<double>(counters.events) / seconds : 0.0; };
+    auto count = [&](OrderType type) { return counters.byType[static_cast<size_t>(type)]; };
+    uint64_t adds = count(OrderType::LIMIT) + count(OrderType::MARKET) + count(OrderType::IOC) +
+                    count(OrderType::FOK) + count(OrderType::STOP) + count(OrderType::STOP_LIMIT);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== Replay: " << label << " ===\n";
+    std::cout << "events            " << counters.events << "\n";
+    std::cout << "wall time (s)     " << wallSeconds << "  (" << rate(wallSeconds) / 1e6 << " M events/s incl. input)\n";
+    std::cout << "book time (s)     " << bookSeconds << "  (" << rate(bookSeconds) / 1e6 << " M events/s)\n";
+    printLatency(latency.snapshot(), ticksPerNs);
+    std::cout << "event mix         limit " << count(OrderType::LIMIT) << "  market " << count(OrderType::MARKET)
+              << "  ioc " << count(OrderType::IOC) << "  fok " << count(OrderType::FOK)
+              << "  stop " << count(OrderType::STOP) + count(OrderType::STOP_LIMIT)
+              << "  cancel " << count(OrderType::CANCEL) << " (" << counters.rejectedCancels << " missed)"
+              << "  modify " << count(OrderType::MODIFY) << " (" << counters.rejectedModifies << " missed)";
+    if (counters.massCancels > 0) {
+        std::cout << "  mass cancel " << counters.massCancels << " (" << counters.massCancelled << " orders)";
+    }
+    if (counters.auctions > 0) {
+        std::cout << "  auctions " << counters.auctions;
+    }
+    std::cout << "\n";
+    std::cout << "cancel ratio      "
+              << (adds ? static_cast<double>(count(OrderType::CANCEL)) / static_cast<double>(adds) : 0.0) << "\n";
+    std::cout << "trades            " << book.getTradeCount() << "\n";
+    if (!options.tape.empty()) {
+        uint64_t rawBytes = tape.tradeCount() * sizeof(Trade);
+        std::cout << "trade tape (MB)   " << static_cast<double>(tape.bytesWritten()) / (1024.0 * 1024.0) << "  ("
+                  << (tape.bytesWritten() ? static_cast<double>(rawBytes) / static_cast<double>(tape.bytesWritten()) : 0.0)
+                  << "x smaller than Trade structs)";
+        if (std::optional<TapeVwap> vwap = computeTapeVwap(options.tape)) {
+            std::cout << "  vwap " << vwap->vwap();
+        }
+        std::cout << "\n";
+    }
+    std::cout << "resting orders    " << book.getOrderCount() << "  (+" << book.getStopCount() << " pending stops)\n";
+    std::cout << "book memory (MB)  " << static_cast<double>(book.getMemoryUsage().total()) / (1024.0 * 1024.0) << "\n";
+    book.printBook(5);
+    return 0;
+}
+
+bool parseArgs(int argc, char** argv, ReplayOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            options.input = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--synthetic") {
+            options.synthetic = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--generate") {
+            options.synthetic = std::strtoull(value.c_str(), nullptr, 10);
+            options.generateOnly = true;
+        } else if (arg == "--out") {
+            options.output = value;
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--ladder") {
+            options.ladderLevels = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--tape") {
+            options.tape = value;
+        } else if (arg == "--pool") {
+            options.poolCapacity = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.generateOnly) {
+        return options.synthetic > 0 && !options.output.empty();
+    }
+    return options.synthetic > 0 || !options.input.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "Usage: replay FILE [--ladder LEVELS] [--pool N] [--tape BASE]\n"
+                     "       replay --synthetic N [--seed S] [--ladder LEVELS] [--pool N] [--tape BASE]\n"
+                     "       replay --generate N --out FILE [--seed S]\n";
+        return 1;
+    }
+    return options.generateOnly ? generate(options) : replay(options);
+}